@@ -1512,6 +1512,92 @@ static void test_reg_delete_key(void)
     RegCloseKey(key);
 }
 
+static void test_many_subkeys(void)
+{
+    char name[16], buffer[16];
+    unsigned int i, index;
+    DWORD ret, size, count;
+    HKEY key, subkey;
+
+    ret = RegCreateKeyA(hkey_main, "manysubkeys", &key);
+    ok(ret == ERROR_SUCCESS, "Could not create key, got %ld\n", ret);
+
+    /* create the keys and values out of order */
+    for (i = 0; i < 2000; i++)
+    {
+        index = (i * 7919) % 2000;
+        sprintf(name, "key%04u", index);
+        ret = RegCreateKeyA(key, name, &subkey);
+        ok(ret == ERROR_SUCCESS, "RegCreateKeyA %s failed, got %ld\n", name, ret);
+        RegCloseKey(subkey);
+        sprintf(name, "value%04u", index);
+        ret = RegSetValueExA(key, name, 0, REG_DWORD, (BYTE *)&index, sizeof(index));
+        ok(ret == ERROR_SUCCESS, "RegSetValueExA %s failed, got %ld\n", name, ret);
+    }
+
+    ret = RegQueryInfoKeyA(key, NULL, NULL, NULL, &count, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    ok(ret == ERROR_SUCCESS, "RegQueryInfoKeyA failed, got %ld\n", ret);
+    ok(count == 2000, "got %lu subkeys\n", count);
+
+    /* subkeys are enumerated in sorted order */
+    for (i = 0; i < 2000; i++)
+    {
+        size = sizeof(buffer);
+        ret = RegEnumKeyExA(key, i, buffer, &size, NULL, NULL, NULL, NULL);
+        ok(ret == ERROR_SUCCESS, "RegEnumKeyExA %u failed, got %ld\n", i, ret);
+        sprintf(name, "key%04u", i);
+        ok(!strcmp(buffer, name), "got %s, expected %s\n", debugstr_a(buffer), debugstr_a(name));
+    }
+
+    /* delete every other key and value */
+    for (i = 0; i < 2000; i += 2)
+    {
+        sprintf(name, "KEY%04u", i);
+        ret = RegDeleteKeyA(key, name);
+        ok(ret == ERROR_SUCCESS, "RegDeleteKeyA %s failed, got %ld\n", name, ret);
+        sprintf(name, "VALUE%04u", i);
+        ret = RegDeleteValueA(key, name);
+        ok(ret == ERROR_SUCCESS, "RegDeleteValueA %s failed, got %ld\n", name, ret);
+    }
+
+    for (i = 0; i < 2000; i++)
+    {
+        sprintf(name, "Key%04u", i);
+        ret = RegOpenKeyA(key, name, &subkey);
+        if (i % 2)
+        {
+            ok(ret == ERROR_SUCCESS, "RegOpenKeyA %s failed, got %ld\n", name, ret);
+            RegCloseKey(subkey);
+        }
+        else ok(ret == ERROR_FILE_NOT_FOUND, "RegOpenKeyA %s got %ld\n", name, ret);
+
+        sprintf(name, "Value%04u", i);
+        size = sizeof(index);
+        ret = RegQueryValueExA(key, name, NULL, NULL, (BYTE *)&index, &size);
+        if (i % 2)
+        {
+            ok(ret == ERROR_SUCCESS, "RegQueryValueExA %s failed, got %ld\n", name, ret);
+            ok(index == i, "got %u for %s\n", index, name);
+        }
+        else ok(ret == ERROR_FILE_NOT_FOUND, "RegQueryValueExA %s got %ld\n", name, ret);
+    }
+
+    for (i = 0; i < 1000; i++)
+    {
+        size = sizeof(buffer);
+        ret = RegEnumKeyExA(key, i, buffer, &size, NULL, NULL, NULL, NULL);
+        ok(ret == ERROR_SUCCESS, "RegEnumKeyExA %u failed, got %ld\n", i, ret);
+        sprintf(name, "key%04u", 2 * i + 1);
+        ok(!strcmp(buffer, name), "got %s, expected %s\n", debugstr_a(buffer), debugstr_a(name));
+    }
+    size = sizeof(buffer);
+    ret = RegEnumKeyExA(key, 1000, buffer, &size, NULL, NULL, NULL, NULL);
+    ok(ret == ERROR_NO_MORE_ITEMS, "RegEnumKeyExA got %ld\n", ret);
+
+    delete_key(key);
+    RegCloseKey(key);
+}
+
 static BOOL set_privileges(LPCSTR privilege, BOOL set)
 {
     TOKEN_PRIVILEGES tp;
@@ -5171,6 +5257,7 @@ START_TEST(registry)
     test_reg_create_key();
     test_reg_close_key();
     test_reg_delete_key();
+    test_many_subkeys();
     test_reg_query_value();
     test_reg_query_info();
     test_string_termination();
@@ -3780,6 +3780,104 @@ static void test_heap_sizes(void)
     }
 }
 
+struct lfh_thread_params
+{
+    HANDLE heap;
+    HANDLE start_event;
+    void *volatile *shared;
+    UINT index;
+};
+
+static DWORD CALLBACK lfh_thread_proc( void *arg )
+{
+    struct lfh_thread_params *params = arg;
+    UINT round, i, errors = 0;
+    BYTE *ptrs[256], *other;
+    SIZE_T size;
+    DWORD res;
+
+    res = WaitForSingleObject( params->start_event, INFINITE );
+    ok( !res, "WaitForSingleObject returned %#lx, error %lu\n", res, GetLastError() );
+
+    for (round = 0; round < 2000; round++)
+    {
+        for (i = 0; i < ARRAY_SIZE(ptrs); i++)
+        {
+            size = 8 + (i + round) % 16 * 8;
+            if (!(ptrs[i] = HeapAlloc( params->heap, 0, size ))) errors++;
+            else memset( ptrs[i], params->index, size );
+        }
+
+        for (i = 0; i < ARRAY_SIZE(ptrs); i++)
+        {
+            size = 8 + (i + round) % 16 * 8;
+            if (!ptrs[i]) continue;
+            if (ptrs[i][0] != params->index || ptrs[i][size - 1] != params->index) errors++;
+
+            /* hand over some blocks to be freed by other threads */
+            if (i % 8) HeapFree( params->heap, 0, ptrs[i] );
+            else if ((other = InterlockedExchangePointer( (void **)&params->shared[i / 8], ptrs[i] )))
+                HeapFree( params->heap, 0, other );
+        }
+    }
+
+    ok( !errors, "got %u errors\n", errors );
+    return 0;
+}
+
+static void test_heap_lfh_threads(void)
+{
+    struct lfh_thread_params params[8];
+    void *volatile shared[32] = {0};
+    HANDLE heap, start_event, threads[ARRAY_SIZE(params)];
+    ULONG compat_info = 2;
+    DWORD res, ticks;
+    UINT i;
+    BOOL ret;
+
+    heap = HeapCreate( 0, 0, 0 );
+    ok( !!heap, "HeapCreate failed, error %lu\n", GetLastError() );
+    ret = pHeapSetInformation( heap, HeapCompatibilityInformation, &compat_info, sizeof(compat_info) );
+    ok( ret, "HeapSetInformation failed, error %lu\n", GetLastError() );
+    start_event = CreateEventW( NULL, TRUE, FALSE, NULL );
+    ok( !!start_event, "CreateEventW failed, error %lu\n", GetLastError() );
+
+    for (i = 0; i < ARRAY_SIZE(params); i++)
+    {
+        params[i].heap = heap;
+        params[i].start_event = start_event;
+        params[i].shared = shared;
+        params[i].index = i + 1;
+        threads[i] = CreateThread( NULL, 0, lfh_thread_proc, params + i, 0, NULL );
+        ok( !!threads[i], "CreateThread failed, error %lu\n", GetLastError() );
+    }
+
+    ticks = GetTickCount();
+    SetEvent( start_event );
+    res = WaitForMultipleObjects( ARRAY_SIZE(threads), threads, TRUE, INFINITE );
+    ok( !res, "WaitForMultipleObjects returned %#lx, error %lu\n", res, GetLastError() );
+    trace( "%u threads allocated and freed %u blocks in %lu ms\n", (UINT)ARRAY_SIZE(params),
+           (UINT)ARRAY_SIZE(params) * 2000 * 256, GetTickCount() - ticks );
+
+    ret = HeapValidate( heap, 0, NULL );
+    ok( ret, "HeapValidate failed, error %lu\n", GetLastError() );
+
+    for (i = 0; i < ARRAY_SIZE(shared); i++)
+    {
+        if (!shared[i]) continue;
+        ret = HeapFree( heap, 0, shared[i] );
+        ok( ret, "HeapFree failed, error %lu\n", GetLastError() );
+    }
+
+    ret = HeapValidate( heap, 0, NULL );
+    ok( ret, "HeapValidate failed, error %lu\n", GetLastError() );
+
+    for (i = 0; i < ARRAY_SIZE(threads); i++) CloseHandle( threads[i] );
+    CloseHandle( start_event );
+    ret = HeapDestroy( heap );
+    ok( ret, "HeapDestroy failed, error %lu\n", GetLastError() );
+}
+
 static void test_HeapSummary(void)
 {
     HANDLE heap;
@@ -3848,6 +3946,7 @@ START_TEST(heap)
     test_GetPhysicallyInstalledSystemMemory();
     test_GlobalMemoryStatus();
     test_HeapSummary();
+    test_heap_lfh_threads();
     test_heap_tail_zeroing( 0 );
 
     if (pRtlGetNtGlobalFlags)
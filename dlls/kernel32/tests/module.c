@@ -353,6 +353,87 @@ static void testGetProcAddress_Wrong(void)
     ok( GetLastError() == ERROR_MOD_NOT_FOUND, "Expected ERROR_MOD_NOT_FOUND, got %ld\n", GetLastError() );
 }
 
+static void testGetProcAddress_all_exports(void)
+{
+    HMODULE module = GetModuleHandleA( "ntdll.dll" );
+    const IMAGE_DOS_HEADER *dos = (const IMAGE_DOS_HEADER *)module;
+    const IMAGE_NT_HEADERS *nt = (const IMAGE_NT_HEADERS *)((const char *)module + dos->e_lfanew);
+    const IMAGE_DATA_DIRECTORY *dir = &nt->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+    const IMAGE_EXPORT_DIRECTORY *exports = (const IMAGE_EXPORT_DIRECTORY *)((const char *)module + dir->VirtualAddress);
+    const DWORD *names = (const DWORD *)((const char *)module + exports->AddressOfNames);
+    const DWORD *functions = (const DWORD *)((const char *)module + exports->AddressOfFunctions);
+    const WORD *ordinals = (const WORD *)((const char *)module + exports->AddressOfNameOrdinals);
+    FARPROC fp;
+    DWORD i;
+
+    ok( exports->NumberOfNames > 1000, "got only %lu exports\n", exports->NumberOfNames );
+
+    for (i = 0; i < exports->NumberOfNames; i++)
+    {
+        const char *name = (const char *)module + names[i];
+        DWORD rva = functions[ordinals[i]];
+
+        fp = GetProcAddress( module, name );
+        if (rva >= dir->VirtualAddress && rva < dir->VirtualAddress + dir->Size)
+            ok( fp != NULL, "forwarded export %s not found\n", name );
+        else
+            ok( fp == (FARPROC)((const char *)module + rva), "got %p for %s, expected %p\n",
+                fp, name, (const char *)module + rva );
+    }
+
+    /* lookups are case sensitive and match the full name */
+    ok( !GetProcAddress( module, "ntclose" ), "ntclose should not be found\n" );
+    ok( !GetProcAddress( module, "NtClos" ), "NtClos should not be found\n" );
+    ok( !GetProcAddress( module, "NtCloseX" ), "NtCloseX should not be found\n" );
+}
+
+/* the name lookup the loader used before export hashing, for comparison */
+static FARPROC bsearch_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *exports, const char *name )
+{
+    const DWORD *names = (const DWORD *)((const char *)module + exports->AddressOfNames);
+    const DWORD *functions = (const DWORD *)((const char *)module + exports->AddressOfFunctions);
+    const WORD *ordinals = (const WORD *)((const char *)module + exports->AddressOfNameOrdinals);
+    int min = 0, max = exports->NumberOfNames - 1;
+
+    while (min <= max)
+    {
+        int res, pos = (min + max) / 2;
+        if (!(res = strcmp( (const char *)module + names[pos], name )))
+            return (FARPROC)((const char *)module + functions[ordinals[pos]]);
+        if (res > 0) max = pos - 1;
+        else min = pos + 1;
+    }
+    return NULL;
+}
+
+static void testGetProcAddress_speed(void)
+{
+    HMODULE module = GetModuleHandleA( "ntdll.dll" );
+    const IMAGE_DOS_HEADER *dos = (const IMAGE_DOS_HEADER *)module;
+    const IMAGE_NT_HEADERS *nt = (const IMAGE_NT_HEADERS *)((const char *)module + dos->e_lfanew);
+    const IMAGE_DATA_DIRECTORY *dir = &nt->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+    const IMAGE_EXPORT_DIRECTORY *exports = (const IMAGE_EXPORT_DIRECTORY *)((const char *)module + dir->VirtualAddress);
+    const DWORD *names = (const DWORD *)((const char *)module + exports->AddressOfNames);
+    DWORD i, round, ticks, found = 0;
+
+    ticks = GetTickCount();
+    for (round = 0; round < 100; round++)
+        for (i = 0; i < exports->NumberOfNames; i++)
+            if (bsearch_export( module, exports, (const char *)module + names[i] )) found++;
+    ticks = GetTickCount() - ticks;
+    ok( found == 100 * exports->NumberOfNames, "found %lu names\n", found );
+    trace( "binary search: %lu lookups in %lu ms\n", found, ticks );
+
+    found = 0;
+    ticks = GetTickCount();
+    for (round = 0; round < 100; round++)
+        for (i = 0; i < exports->NumberOfNames; i++)
+            if (GetProcAddress( module, (const char *)module + names[i] )) found++;
+    ticks = GetTickCount() - ticks;
+    ok( found == 100 * exports->NumberOfNames, "found %lu names\n", found );
+    trace( "GetProcAddress: %lu lookups in %lu ms\n", found, ticks );
+}
+
 static void testLoadLibraryEx(void)
 {
     CHAR path[MAX_PATH];
@@ -2003,6 +2084,8 @@ START_TEST(module)
     testNestedLoadLibraryA();
     testLoadLibraryA_Wrong();
     testGetProcAddress_Wrong();
+    testGetProcAddress_all_exports();
+    testGetProcAddress_speed();
     testLoadLibraryEx();
     test_LoadLibraryEx_search_flags();
     testGetModuleHandleEx();
@@ -4730,6 +4730,43 @@ static void test_FlushProcessWriteBuffers(void)
     ok( !reorderings, "expected sequential consistency with FlushProcessWriteBuffers (got %ld reorderings)\n", reorderings );
 }
 
+static void test_large_pages(void)
+{
+    SIZE_T large_page = GetLargePageMinimum();
+    MEMORY_BASIC_INFORMATION info;
+    char *ptr;
+    BOOL ret;
+
+    if (!large_page)
+    {
+        skip( "large pages are not supported\n" );
+        return;
+    }
+    ok( !(large_page & (large_page - 1)), "got large page size %#Ix\n", large_page );
+    ok( large_page >= si.dwAllocationGranularity, "got large page size %#Ix\n", large_page );
+
+    SetLastError( 0xdeadbeef );
+    ptr = VirtualAlloc( NULL, large_page, MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE );
+    ok( !ptr, "VirtualAlloc succeeded\n" );
+    ok( GetLastError() == ERROR_INVALID_PARAMETER || broken(GetLastError() == ERROR_PRIVILEGE_NOT_HELD),
+        "got error %lu\n", GetLastError() );
+
+    /* this requires SeLockMemoryPrivilege on Windows */
+    ptr = VirtualAlloc( NULL, large_page, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+    if (!ptr)
+    {
+        ok( GetLastError() == ERROR_PRIVILEGE_NOT_HELD, "got error %lu\n", GetLastError() );
+        return;
+    }
+    ok( !((UINT_PTR)ptr & (large_page - 1)), "got unaligned address %p\n", ptr );
+    ptr[0] = ptr[large_page - 1] = 1;
+    ok( VirtualQuery( ptr, &info, sizeof(info) ) == sizeof(info), "VirtualQuery failed\n" );
+    ok( info.RegionSize == large_page, "got size %#Ix\n", info.RegionSize );
+    ok( info.State == MEM_COMMIT, "got state %#lx\n", info.State );
+    ret = VirtualFree( ptr, 0, MEM_RELEASE );
+    ok( ret, "VirtualFree failed, error %lu\n", GetLastError() );
+}
+
 START_TEST(virtual)
 {
     int argc;
@@ -4814,6 +4851,7 @@ START_TEST(virtual)
     test_PrefetchVirtualMemory();
     test_ReadProcessMemory();
     test_FlushProcessWriteBuffers();
+    test_large_pages();
 #if defined(__i386__) || defined(__x86_64__)
     test_stack_commit();
 #endif
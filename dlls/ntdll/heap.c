@@ -32,6 +32,7 @@
 #include "windef.h"
 #include "winnt.h"
 #include "winternl.h"
+#include "ddk/wdm.h"
 #include "ntdll_misc.h"
 #include "wine/list.h"
 #include "wine/debug.h"
@@ -176,7 +177,11 @@ C_ASSERT( FREE_LIST_COUNT == 0x3d );
 
 typedef struct DECLSPEC_ALIGN(BLOCK_ALIGN) tagSUBHEAP
 {
-    SIZE_T __pad[sizeof(SIZE_T) / sizeof(DWORD)];
+    union
+    {
+        SIZE_T __pad[sizeof(SIZE_T) / sizeof(DWORD)];
+        BOOL large_pages;  /* region is committed with large pages and can't be decommitted */
+    } u;
     SIZE_T block_size;
     SIZE_T data_size;
     struct list entry;
@@ -329,6 +334,7 @@ C_ASSERT( HEAP_MIN_LARGE_BLOCK_SIZE <= HEAP_INITIAL_GROW_SIZE );
 #define HEAP_CHECKING_ENABLED 0x80000000
 
 static struct heap *process_heap;  /* main process heap */
+static SIZE_T large_page_size;  /* use large pages for regions of at least that size, if set */
 
 static NTSTATUS heap_free_block_lfh( struct heap *heap, ULONG flags, struct block *block );
 
@@ -832,6 +838,9 @@ static inline BOOL subheap_decommit( const struct heap *heap, SUBHEAP *subheap,
     SIZE_T size;
     void *addr;
 
+    /* keep large page regions committed, decommitting would split the large pages */
+    if (subheap->u.large_pages) return TRUE;
+
     commit_end = ROUND_ADDR( (char *)commit_end + REGION_ALIGN - 1, REGION_ALIGN - 1 );
     if (subheap == &heap->subheap) commit_end = max( (char *)commit_end, (char *)base + heap->min_size );
     if (commit_end >= subheap_commit_end( subheap )) return TRUE;
@@ -968,12 +977,15 @@ static struct block *split_block( struct heap *heap, ULONG flags, struct block *
 }
 
 
-static void *allocate_region( struct heap *heap, ULONG flags, SIZE_T *region_size, SIZE_T *commit_size )
+static void *allocate_region( struct heap *heap, ULONG flags, SIZE_T *region_size, SIZE_T *commit_size,
+                              BOOL *large_pages )
 {
     const SIZE_T align = 0x400 * sizeof(void*);  /* minimum alignment for virtual allocations */
     void *addr = NULL;
     NTSTATUS status;
 
+    if (large_pages) *large_pages = FALSE;
+
     if (heap && !(flags & HEAP_GROWABLE))
     {
         WARN( "Heap %p isn't growable, cannot allocate %#Ix bytes\n", heap, *region_size );
@@ -983,6 +995,28 @@ static void *allocate_region( struct heap *heap, ULONG flags, SIZE_T *region_siz
     *region_size = ROUND_SIZE( *region_size, align - 1 );
     *commit_size = ROUND_SIZE( *commit_size, align - 1 );
 
+    if (large_page_size && *region_size >= large_page_size)
+    {
+        /* large pages have to be committed at once */
+        SIZE_T size = ROUND_SIZE( *region_size, large_page_size - 1 );
+
+        if (size > HEAP_MAX_BLOCK_REGION_SIZE)
+            TRACE( "Region of %#Ix bytes is too large for large pages\n", size );
+        else if (!(status = NtAllocateVirtualMemory( NtCurrentProcess(), &addr, 0, &size,
+                                                     MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                                                     get_protection_type( flags ) )))
+        {
+            *region_size = *commit_size = size;
+            if (large_pages) *large_pages = TRUE;
+            return addr;
+        }
+        else
+        {
+            WARN( "Could not allocate %#Ix bytes with large pages, status %#lx\n", size, status );
+            addr = NULL;
+        }
+    }
+
     /* allocate the memory block */
     if ((status = NtAllocateVirtualMemory( NtCurrentProcess(), &addr, 0, region_size, MEM_RESERVE,
                                            get_protection_type( flags ) )))
@@ -1009,7 +1043,7 @@ static NTSTATUS heap_allocate_large( struct heap *heap, ULONG flags, SIZE_T bloc
     struct block *block;
 
     if (total_size < size) return STATUS_NO_MEMORY;  /* overflow */
-    if (!(arena = allocate_region( heap, flags, &total_size, &total_size ))) return STATUS_NO_MEMORY;
+    if (!(arena = allocate_region( heap, flags, &total_size, &total_size, NULL ))) return STATUS_NO_MEMORY;
 
     block = &arena->block;
     arena->data_size = size;
@@ -1089,12 +1123,14 @@ static SUBHEAP *create_subheap( struct heap *heap, DWORD flags, SIZE_T total_siz
 {
     SIZE_T block_size;
     SUBHEAP *subheap;
+    BOOL large_pages;
 
     commit_size = ROUND_SIZE( max( commit_size, REGION_ALIGN ), REGION_ALIGN - 1 );
     total_size = min( max( commit_size, total_size ), 0xffff0000 );  /* don't allow a heap larger than 4GB */
 
-    if (!(subheap = allocate_region( heap, flags, &total_size, &commit_size ))) return NULL;
+    if (!(subheap = allocate_region( heap, flags, &total_size, &commit_size, &large_pages ))) return NULL;
 
+    subheap->u.large_pages = large_pages;
     subheap->user_value = heap;
     subheap_set_bounds( subheap, (char *)subheap + commit_size, (char *)subheap + total_size );
     block_size = (SIZE_T)ROUND_ADDR( subheap_size( subheap ) - subheap_overhead( subheap ), BLOCK_ALIGN - 1 );
@@ -1499,6 +1535,7 @@ static void heap_set_debug_flags( HANDLE handle )
 HANDLE WINAPI RtlCreateHeap( ULONG flags, void *addr, SIZE_T total_size, SIZE_T commit_size,
                              void *lock, RTL_HEAP_PARAMETERS *params )
 {
+    BOOL large_pages = FALSE;
     struct entry *entry;
     struct heap *heap;
     SIZE_T block_size;
@@ -1518,7 +1555,7 @@ HANDLE WINAPI RtlCreateHeap( ULONG flags, void *addr, SIZE_T total_size, SIZE_T
         if (!commit_size) commit_size = REGION_ALIGN;
         total_size = min( max( total_size, commit_size ), 0xffff0000 );  /* don't allow a heap larger than 4GB */
         commit_size = min( total_size, ROUND_SIZE( commit_size, REGION_ALIGN - 1 ) );
-        if (!(heap = allocate_region( NULL, flags, &total_size, &commit_size ))) return 0;
+        if (!(heap = allocate_region( NULL, flags, &total_size, &commit_size, &large_pages ))) return 0;
     }
 
     heap->ffeeffee      = 0xffeeffee;
@@ -1558,6 +1595,7 @@ HANDLE WINAPI RtlCreateHeap( ULONG flags, void *addr, SIZE_T total_size, SIZE_T
     }
 
     subheap = &heap->subheap;
+    subheap->u.large_pages = large_pages;
     subheap->user_value = heap;
     subheap_set_bounds( subheap, (char *)heap + commit_size, (char *)heap + total_size );
     block_size = (SIZE_T)ROUND_ADDR( subheap_size( subheap ) - subheap_overhead( subheap ), BLOCK_ALIGN - 1 );
@@ -1740,12 +1778,17 @@ struct DECLSPEC_ALIGN(BLOCK_ALIGN) group
     SLIST_ENTRY entry;
     /* one bit for each free block and the highest bit for GROUP_FLAG_FREE */
     LONG free_bits;
+    /* free blocks reserved from free_bits, only accessed by the thread owning the group */
+    LONG cached_bits;
     /* affinity of the thread which last allocated from this group */
     LONG affinity;
+    DWORD __pad[2 * sizeof(SIZE_T) / sizeof(DWORD) - 1];
     /* first block of a group, required for alignment */
     struct block first_block;
 };
 
+C_ASSERT( (offsetof(struct group, first_block) + sizeof(struct block)) % BLOCK_ALIGN == 0 );
+
 #define GROUP_BLOCK_COUNT     (sizeof(((struct group *)0)->free_bits) * 8 - 1)
 #define GROUP_FLAG_FREE       (1u << GROUP_BLOCK_COUNT)
 
@@ -1773,13 +1816,18 @@ static inline struct block *group_get_block( struct group *group, SIZE_T block_s
     return (struct block *)(first_block + index * block_size);
 }
 
-/* lookup a free block using the group free_bits, the current thread must own the group */
+/* lookup a free block using the group cached_bits, the current thread must own the group */
 static inline struct block *group_find_free_block( struct group *group, SIZE_T block_size )
 {
-    ULONG i, free_bits = ReadNoFence( &group->free_bits );
-    /* free_bits will never be 0 as the group is unlinked when it's fully used */
-    BitScanForward( &i, free_bits );
-    InterlockedAnd( &group->free_bits, ~(1 << i) );
+    ULONG i;
+
+    /* reserve all the currently free blocks at once, so that the following allocations from
+     * this group don't need any atomic operation on free_bits. free_bits will never be 0 here
+     * as the group is unlinked when it's fully used.
+     */
+    if (!group->cached_bits) group->cached_bits = InterlockedExchange( &group->free_bits, 0 );
+    BitScanForward( &i, group->cached_bits );
+    group->cached_bits &= ~(1 << i);
     return group_get_block( group, block_size, i );
 }
 
@@ -1806,6 +1854,7 @@ static struct group *group_allocate( struct heap *heap, ULONG flags, SIZE_T bloc
 
     block_set_flags( (struct block *)group - 1, 0, BLOCK_FLAG_LFH );
     group->free_bits = ~GROUP_FLAG_FREE;
+    group->cached_bits = 0;
 
     for (i = 0; i < GROUP_BLOCK_COUNT; ++i)
     {
@@ -1906,8 +1955,11 @@ static struct block *find_free_bin_block( struct heap *heap, ULONG flags, SIZE_T
 
     block = group_find_free_block( group, block_size );
 
-    /* serialize with heap_free_block_lfh: atomically set GROUP_FLAG_FREE when the free bits are all 0. */
-    if (ReadNoFence( &group->free_bits ) || InterlockedCompareExchange( &group->free_bits, GROUP_FLAG_FREE, 0 ))
+    /* serialize with heap_free_block_lfh: atomically set GROUP_FLAG_FREE when the free bits are all 0
+     * and the group has no reserved blocks left.
+     */
+    if (group->cached_bits || ReadNoFence( &group->free_bits ) ||
+        InterlockedCompareExchange( &group->free_bits, GROUP_FLAG_FREE, 0 ))
     {
         /* if GROUP_FLAG_FREE isn't set, thread is responsible for putting it back into group list. */
         if ((group = InterlockedExchangePointer( (void *)bin_get_affinity_group( bin, affinity ), group )))
@@ -2017,6 +2069,17 @@ static void heap_thread_detach_bin_groups( struct heap *heap )
     }
 }
 
+/***********************************************************************
+ *           heap_enable_large_pages
+ *
+ * Allocate the heap regions that are large enough using large pages.
+ */
+void heap_enable_large_pages(void)
+{
+    large_page_size = user_shared_data->LargePageMinimum;
+    TRACE( "using large pages for heap regions of at least %#Ix bytes\n", large_page_size );
+}
+
 void heap_thread_detach(void)
 {
     struct heap *heap;
@@ -140,8 +140,13 @@ typedef struct _wine_modref
     struct file_id        id;
     ULONG                 CheckSum;
     BOOL                  system;
+    const IMAGE_EXPORT_DIRECTORY *hash_exports;  /* export directory indexed by export_hash */
+    DWORD                *export_hash;           /* export name hash table, name index + 1 */
+    DWORD                 export_hash_mask;      /* export name hash table size - 1 */
 } WINE_MODREF;
 
+#define EXPORT_HASH_MIN_NAMES 64  /* smaller export tables use a binary search */
+
 static UINT tls_module_count = 32;     /* number of modules with TLS directory */
 static IMAGE_TLS_DIRECTORY *tls_dirs;  /* array of TLS directories */
 
@@ -1077,6 +1082,77 @@ static int find_name_in_exports( HMODULE module, const IMAGE_EXPORT_DIRECTORY *e
 }
 
 
+/*************************************************************************
+ *		hash_export_name
+ */
+static inline DWORD hash_export_name( const char *name )
+{
+    DWORD hash = 2166136261u;
+
+    while (*name) hash = (hash ^ (unsigned char)*name++) * 16777619;
+    return hash;
+}
+
+
+/*************************************************************************
+ *		build_export_hash
+ *
+ * Build the export name hash table of a module.
+ * The loader_section must be locked while calling this function.
+ */
+static BOOL build_export_hash( WINE_MODREF *wm, const IMAGE_EXPORT_DIRECTORY *exports )
+{
+    const DWORD *names = get_rva( wm->ldr.DllBase, exports->AddressOfNames );
+    DWORD i, pos, mask = 1, *hash;
+
+    while (mask < 2 * exports->NumberOfNames) mask <<= 1;
+    mask--;
+
+    if (!(hash = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY, (mask + 1) * sizeof(*hash) )))
+        return FALSE;
+
+    for (i = 0; i < exports->NumberOfNames; i++)
+    {
+        pos = hash_export_name( get_rva( wm->ldr.DllBase, names[i] )) & mask;
+        while (hash[pos]) pos = (pos + 1) & mask;
+        hash[pos] = i + 1;
+    }
+
+    RtlFreeHeap( GetProcessHeap(), 0, wm->export_hash );
+    wm->export_hash = hash;
+    wm->export_hash_mask = mask;
+    wm->hash_exports = exports;
+    return TRUE;
+}
+
+
+/*************************************************************************
+ *		find_name_in_export_hash
+ *
+ * Helper for find_named_export. The hash table is built on the first lookup.
+ * The loader_section must be locked while calling this function.
+ */
+static int find_name_in_export_hash( HMODULE module, const IMAGE_EXPORT_DIRECTORY *exports, const char *name )
+{
+    const WORD *ordinals = get_rva( module, exports->AddressOfNameOrdinals );
+    const DWORD *names = get_rva( module, exports->AddressOfNames );
+    WINE_MODREF *wm;
+    DWORD pos, idx;
+
+    if (exports->NumberOfNames < EXPORT_HASH_MIN_NAMES || !(wm = get_modref( module )) ||
+        (wm->hash_exports != exports && !build_export_hash( wm, exports )))
+        return find_name_in_exports( module, exports, name );
+
+    pos = hash_export_name( name ) & wm->export_hash_mask;
+    while ((idx = wm->export_hash[pos]))
+    {
+        if (!strcmp( get_rva( module, names[idx - 1] ), name )) return ordinals[idx - 1];
+        pos = (pos + 1) & wm->export_hash_mask;
+    }
+    return -1;
+}
+
+
 /*************************************************************************
  *		find_named_export
  *
@@ -1099,8 +1175,8 @@ static FARPROC find_named_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *
             return find_ordinal_export( module, exports, exp_size, ordinals[hint], load_path, importer, is_dynamic );
     }
 
-    /* then do a binary search */
-    if ((ordinal = find_name_in_exports( module, exports, name )) == -1) return NULL;
+    /* then look it up in the hash table */
+    if ((ordinal = find_name_in_export_hash( module, exports, name )) == -1) return NULL;
     return find_ordinal_export( module, exports, exp_size, ordinal, load_path, importer, is_dynamic );
 
 }
@@ -1729,6 +1805,20 @@ static NTSTATUS MODULE_InitDLL( WINE_MODREF *wm, UINT reason, LPVOID lpReserved
 }
 
 
+/*************************************************************************
+ *		get_elapsed_usecs
+ *
+ * Return the time elapsed since start, for the +loaddll load time traces.
+ */
+static unsigned int get_elapsed_usecs( const LARGE_INTEGER *start )
+{
+    LARGE_INTEGER now, freq;
+
+    NtQueryPerformanceCounter( &now, &freq );
+    return (now.QuadPart - start->QuadPart) * 1000000 / freq.QuadPart;
+}
+
+
 /*************************************************************************
  *		process_attach
  *
@@ -1764,6 +1854,7 @@ static NTSTATUS process_attach( LDR_DDAG_NODE *node, LPVOID lpReserved )
 {
     NTSTATUS status = STATUS_SUCCESS;
     LDR_DATA_TABLE_ENTRY *mod;
+    LARGE_INTEGER start;
     ULONG_PTR cookie;
     WINE_MODREF *wm;
 
@@ -1799,7 +1890,11 @@ static NTSTATUS process_attach( LDR_DDAG_NODE *node, LPVOID lpReserved )
     if (status == STATUS_SUCCESS)
     {
         call_ldr_notifications( LDR_DLL_NOTIFICATION_REASON_LOADED, &wm->ldr );
+        if (TRACE_ON(loaddll)) NtQueryPerformanceCounter( &start, NULL );
         status = MODULE_InitDLL( wm, DLL_PROCESS_ATTACH, lpReserved );
+        if (TRACE_ON(loaddll))
+            TRACE_(loaddll)( "Initialized %s in %u us\n", debugstr_w(wm->ldr.BaseDllName.Buffer),
+                             get_elapsed_usecs( &start ));
         if (status == STATUS_SUCCESS)
         {
             wm->ldr.Flags |= LDR_PROCESS_ATTACHED;
@@ -3327,11 +3422,14 @@ static NTSTATUS load_dll( const WCHAR *load_path, const WCHAR *libname, DWORD fl
     HANDLE mapping = 0;
     SECTION_IMAGE_INFORMATION image_info;
     NTSTATUS nts = STATUS_DLL_NOT_FOUND;
+    LARGE_INTEGER start;
     BOOL redirected;
     void *prev;
 
     TRACE( "looking for %s in %s\n", debugstr_w(libname), debugstr_w(load_path) );
 
+    if (TRACE_ON(loaddll)) NtQueryPerformanceCounter( &start, NULL );
+
     if (system && system_dll_path.Buffer)
         nts = search_dll_file( system_dll_path.Buffer, libname, &nt_name, pwm, &mapping, &image_info, &id );
 
@@ -3374,7 +3472,12 @@ static NTSTATUS load_dll( const WCHAR *load_path, const WCHAR *libname, DWORD fl
 
 done:
     if (nts == STATUS_SUCCESS)
+    {
         TRACE("Loaded module %s at %p\n", debugstr_us(&nt_name), (*pwm)->ldr.DllBase);
+        if (TRACE_ON(loaddll))
+            TRACE_(loaddll)( "Loaded %s and its imports in %u us\n",
+                             debugstr_w((*pwm)->ldr.BaseDllName.Buffer), get_elapsed_usecs( &start ));
+    }
     else
         WARN("Failed to load module %s; status=%lx\n", debugstr_w(libname), nts);
 
@@ -4021,6 +4124,7 @@ static void free_modref( WINE_MODREF *wm )
     NtUnmapViewOfSection( NtCurrentProcess(), wm->ldr.DllBase );
     if (cached_modref == wm) cached_modref = NULL;
     RtlFreeUnicodeString( &wm->ldr.FullDllName );
+    RtlFreeHeap( GetProcessHeap(), 0, wm->export_hash );
     RtlFreeHeap( GetProcessHeap(), 0, wm );
 }
 
@@ -4166,15 +4270,22 @@ static void load_global_options(void)
 {
     OBJECT_ATTRIBUTES attr;
     UNICODE_STRING bootstrap_mode_str = RTL_CONSTANT_STRING( L"WINEBOOTSTRAPMODE" );
+    UNICODE_STRING large_pages_str = RTL_CONSTANT_STRING( L"WINE_HEAP_LARGE_PAGES" );
     UNICODE_STRING session_manager_str =
         RTL_CONSTANT_STRING( L"\\Registry\\Machine\\System\\CurrentControlSet\\Control\\Session Manager" );
     UNICODE_STRING val_str;
+    WCHAR buffer[8];
     HANDLE hkey;
 
     val_str.MaximumLength = 0;
     is_prefix_bootstrap =
         RtlQueryEnvironmentVariable_U( NULL, &bootstrap_mode_str, &val_str ) != STATUS_VARIABLE_NOT_FOUND;
 
+    val_str.Buffer = buffer;
+    val_str.MaximumLength = sizeof(buffer);
+    if (!RtlQueryEnvironmentVariable_U( NULL, &large_pages_str, &val_str ) && val_str.Length && buffer[0] != '0')
+        heap_enable_large_pages();
+
     InitializeObjectAttributes( &attr, &session_manager_str, OBJ_CASE_INSENSITIVE, 0, NULL );
     if (!NtOpenKey( &hkey, KEY_QUERY_VALUE, &attr ))
     {
@@ -121,6 +121,7 @@ static inline void ascii_to_unicode( WCHAR *dst, const char *src, size_t len )
 /* FLS data */
 extern TEB_FLS_DATA *fls_alloc_data(void);
 extern void heap_thread_detach(void);
+extern void heap_enable_large_pages(void);
 
 /* register context */
 
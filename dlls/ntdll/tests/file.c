@@ -1124,6 +1124,54 @@ static void test_set_io_completion(void)
     pNtClose( h );
 }
 
+static void test_remove_io_completion_batch(void)
+{
+    FILE_IO_COMPLETION_INFORMATION info[80];
+    LARGE_INTEGER timeout = {{0}};
+    NTSTATUS res;
+    ULONG count, i;
+    HANDLE h;
+
+    if (!pNtRemoveIoCompletionEx)
+    {
+        skip("NtRemoveIoCompletionEx() not present\n");
+        return;
+    }
+
+    res = pNtCreateIoCompletion( &h, IO_COMPLETION_ALL_ACCESS, NULL, 0 );
+    ok( res == STATUS_SUCCESS, "NtCreateIoCompletion failed: %#lx\n", res );
+
+    for (i = 0; i < 100; i++)
+    {
+        res = pNtSetIoCompletion( h, i, i + 1000, 0, i + 2000 );
+        ok( res == STATUS_SUCCESS, "NtSetIoCompletion failed: %#lx\n", res );
+    }
+
+    count = 0xdeadbeef;
+    res = pNtRemoveIoCompletionEx( h, info, ARRAY_SIZE(info), &count, &timeout, FALSE );
+    ok( res == STATUS_SUCCESS, "NtRemoveIoCompletionEx failed: %#lx\n", res );
+    ok( count == ARRAY_SIZE(info), "wrong count %lu\n", count );
+    for (i = 0; i < count; i++)
+    {
+        ok( info[i].CompletionKey == i, "%lu: wrong key %#Ix\n", i, info[i].CompletionKey );
+        ok( info[i].CompletionValue == i + 1000, "%lu: wrong value %#Ix\n", i, info[i].CompletionValue );
+        ok( info[i].IoStatusBlock.Information == i + 2000, "%lu: wrong information %#Ix\n",
+            i, info[i].IoStatusBlock.Information );
+    }
+
+    count = 0xdeadbeef;
+    res = pNtRemoveIoCompletionEx( h, info, ARRAY_SIZE(info), &count, &timeout, FALSE );
+    ok( res == STATUS_SUCCESS, "NtRemoveIoCompletionEx failed: %#lx\n", res );
+    ok( count == 20, "wrong count %lu\n", count );
+    for (i = 0; i < count; i++)
+        ok( info[i].CompletionKey == i + 80, "%lu: wrong key %#Ix\n", i, info[i].CompletionKey );
+
+    count = get_pending_msgs( h );
+    ok( !count, "Unexpected msg count: %ld\n", count );
+
+    pNtClose( h );
+}
+
 static void test_file_io_completion(void)
 {
     static const char pipe_name[] = "\\\\.\\pipe\\iocompletiontestnamedpipe";
@@ -4878,6 +4926,45 @@ static void test_query_attribute_information_file(void)
     CloseHandle( dir );
 }
 
+static void test_long_name_component(void)
+{
+    static const ULONG dispositions[] = { FILE_OPEN, FILE_CREATE };
+    WCHAR path[MAX_PATH + 300];
+    OBJECT_ATTRIBUTES attr;
+    UNICODE_STRING nameW;
+    IO_STATUS_BLOCK io;
+    NTSTATUS status, first;
+    unsigned int i, j, len;
+    HANDLE file;
+
+    /* a component longer than the maximum file name length, in a directory
+     * which is not being modified, looked up several times in a row */
+    GetWindowsDirectoryW( path, MAX_PATH );
+    len = wcslen( path );
+    path[len++] = '\\';
+    for (i = 0; i < 300; i++) path[len++] = 'a' + i % 26;
+    path[len] = 0;
+    pRtlDosPathNameToNtPathName_U( path, &nameW, NULL, NULL );
+    InitializeObjectAttributes( &attr, &nameW, OBJ_CASE_INSENSITIVE, 0, NULL );
+
+    for (i = 0; i < ARRAY_SIZE(dispositions); i++)
+    {
+        for (j = 0; j < 2; j++)
+        {
+            status = pNtCreateFile( &file, GENERIC_READ | SYNCHRONIZE, &attr, &io, NULL, 0,
+                                    FILE_SHARE_READ | FILE_SHARE_WRITE, dispositions[i],
+                                    FILE_NON_DIRECTORY_FILE, NULL, 0 );
+            ok( status == STATUS_OBJECT_NAME_INVALID || status == STATUS_OBJECT_NAME_NOT_FOUND,
+                "%u/%u: got %#lx\n", i, j, status );
+            if (!status) CloseHandle( file );
+            if (!j) first = status;
+            else ok( status == first, "%u: got %#lx, previously %#lx\n", i, status, first );
+        }
+    }
+
+    pRtlFreeUnicodeString( &nameW );
+}
+
 static void test_NtCreateFile(void)
 {
     static const struct test_data
@@ -7383,6 +7470,7 @@ START_TEST(file)
 
     test_read_write();
     test_NtCreateFile();
+    test_long_name_component();
     create_file_test();
     open_file_test();
     delete_file_test();
@@ -7391,6 +7479,7 @@ START_TEST(file)
     nt_mailslot_test();
     test_set_io_completion();
     test_set_io_completion_ex();
+    test_remove_io_completion_batch();
     test_file_io_completion();
     test_file_basic_information();
     test_file_all_information();
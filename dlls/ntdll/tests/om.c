@@ -2323,6 +2323,53 @@ static void test_duplicate_object(void)
     if (!status) pNtClose( handle );
 }
 
+static void test_many_handles(void)
+{
+    static const unsigned int count = 10000;
+    HANDLE event, handle, *handles;
+    NTSTATUS status;
+    unsigned int i;
+
+    handles = malloc( count * sizeof(*handles) );
+    status = pNtCreateEvent( &event, EVENT_ALL_ACCESS, NULL, NotificationEvent, FALSE );
+    ok( !status, "NtCreateEvent failed %lx\n", status );
+
+    for (i = 0; i < count; i++)
+    {
+        status = pNtDuplicateObject( GetCurrentProcess(), event, GetCurrentProcess(),
+                                     &handles[i], 0, 0, DUPLICATE_SAME_ACCESS );
+        ok( !status, "NtDuplicateObject %u failed %lx\n", i, status );
+    }
+
+    /* free some handles and allocate them again */
+    for (i = 0; i < count; i += 1000)
+    {
+        status = pNtClose( handles[i] );
+        ok( !status, "NtClose %u failed %lx\n", i, status );
+    }
+    for (i = 0; i < count; i += 1000)
+    {
+        status = pNtDuplicateObject( GetCurrentProcess(), event, GetCurrentProcess(),
+                                     &handles[i], 0, 0, DUPLICATE_SAME_ACCESS );
+        ok( !status, "NtDuplicateObject %u failed %lx\n", i, status );
+    }
+
+    status = pNtDuplicateObject( GetCurrentProcess(), event, GetCurrentProcess(),
+                                 &handle, 0, 0, DUPLICATE_SAME_ACCESS );
+    ok( !status, "NtDuplicateObject failed %lx\n", status );
+    for (i = 0; i < count; i++) if (handles[i] == handle) break;
+    ok( i == count, "handle %p already in use\n", handle );
+    pNtClose( handle );
+
+    for (i = 0; i < count; i++)
+    {
+        status = pNtClose( handles[i] );
+        ok( !status, "NtClose %u failed %lx\n", i, status );
+    }
+    pNtClose( event );
+    free( handles );
+}
+
 static void test_object_types(void)
 {
     static const struct { const WCHAR *name; GENERIC_MAPPING mapping; ULONG mask, broken; } tests[] =
@@ -3941,6 +3988,7 @@ START_TEST(om)
     test_process();
     test_token();
     test_duplicate_object();
+    test_many_handles();
     test_object_types();
     test_get_next_thread();
     test_get_next_process();
@@ -870,6 +870,57 @@ static void CALLBACK wait_release_cb(TP_CALLBACK_INSTANCE *instance, void *userd
     pTpReleaseWait(wait);
 }
 
+static void CALLBACK counter_work_cb(TP_CALLBACK_INSTANCE *instance, void *userdata, TP_WORK *work)
+{
+    InterlockedIncrement((LONG *)userdata);
+}
+
+static void test_tp_work_throughput(void)
+{
+    TP_CALLBACK_ENVIRON environment;
+    TP_WORK *work[8];
+    LONG userdata[8];
+    TP_POOL *pool;
+    NTSTATUS status;
+    DWORD ticks;
+    int i, j;
+
+    /* allocate new threadpool */
+    pool = NULL;
+    status = pTpAllocPool(&pool, NULL);
+    ok(!status, "TpAllocPool failed with status %lx\n", status);
+    ok(pool != NULL, "expected pool != NULL\n");
+
+    memset(&environment, 0, sizeof(environment));
+    environment.Version = 1;
+    environment.Pool = pool;
+    for (i = 0; i < ARRAY_SIZE(work); i++)
+    {
+        userdata[i] = 0;
+        work[i] = NULL;
+        status = pTpAllocWork(&work[i], counter_work_cb, &userdata[i], &environment);
+        ok(!status, "TpAllocWork failed with status %lx\n", status);
+        ok(work[i] != NULL, "expected work != NULL\n");
+    }
+
+    /* post a lot of tiny work items */
+    ticks = GetTickCount();
+    for (j = 0; j < 20000; j++)
+        for (i = 0; i < ARRAY_SIZE(work); i++)
+            pTpPostWork(work[i]);
+    for (i = 0; i < ARRAY_SIZE(work); i++)
+    {
+        pTpWaitForWork(work[i], FALSE);
+        ok(userdata[i] == 20000, "expected userdata = 20000, got %lu\n", userdata[i]);
+    }
+    trace("executed %u work callbacks in %lu ms\n", (unsigned int)ARRAY_SIZE(work) * 20000, GetTickCount() - ticks);
+
+    /* cleanup */
+    for (i = 0; i < ARRAY_SIZE(work); i++)
+        pTpReleaseWork(work[i]);
+    pTpReleasePool(pool);
+}
+
 static void test_tp_group_wait(void)
 {
     TP_CALLBACK_ENVIRON environment;
@@ -2484,6 +2535,7 @@ START_TEST(threadpool)
     test_tp_simple();
     test_tp_work();
     test_tp_work_scheduler();
+    test_tp_work_throughput();
     test_tp_group_wait();
     test_tp_group_cancel();
     test_tp_instance();
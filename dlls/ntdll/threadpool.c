@@ -1144,11 +1144,12 @@ static void CALLBACK timerqueue_thread_proc( void *param )
 }
 
 /***********************************************************************
- *           tp_new_worker_thread    (internal)
+ *           tp_start_worker_thread    (internal)
  *
- * Create and account a new worker thread for the desired pool.
+ * Create a worker thread for the desired pool, the caller is responsible
+ * for accounting it.
  */
-static NTSTATUS tp_new_worker_thread( struct threadpool *pool )
+static NTSTATUS tp_start_worker_thread( struct threadpool *pool )
 {
     HANDLE thread;
     NTSTATUS status;
@@ -1156,11 +1157,25 @@ static NTSTATUS tp_new_worker_thread( struct threadpool *pool )
     status = RtlCreateUserThread( GetCurrentProcess(), NULL, FALSE, 0,
                                   pool->stack_info.StackReserve, pool->stack_info.StackCommit,
                                   threadpool_worker_proc, pool, &thread, NULL );
+    if (status == STATUS_SUCCESS)
+        NtClose( thread );
+    return status;
+}
+
+/***********************************************************************
+ *           tp_new_worker_thread    (internal)
+ *
+ * Create and account a new worker thread for the desired pool.
+ */
+static NTSTATUS tp_new_worker_thread( struct threadpool *pool )
+{
+    NTSTATUS status;
+
+    status = tp_start_worker_thread( pool );
     if (status == STATUS_SUCCESS)
     {
         InterlockedIncrement( &pool->refcount );
         pool->num_workers++;
-        NtClose( thread );
     }
     return status;
 }
@@ -1998,16 +2013,23 @@ static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
 {
     struct threadpool *pool = object->pool;
     NTSTATUS status = STATUS_UNSUCCESSFUL;
+    BOOL new_worker = FALSE;
 
     assert( !object->shutdown );
     assert( !pool->shutdown );
 
     RtlEnterCriticalSection( &pool->cs );
 
-    /* Start new worker threads if required. */
+    /* Account a new worker thread if required, it is started after leaving
+     * the critical section to not block other submitters and the workers. */
     if (pool->num_busy_workers >= pool->num_workers &&
         pool->num_workers < pool->max_workers)
-        status = tp_new_worker_thread( pool );
+    {
+        InterlockedIncrement( &pool->refcount );
+        pool->num_workers++;
+        new_worker = TRUE;
+    }
+    else assert( pool->num_workers > 0 );
 
     /* Queue work item and increment refcount. */
     InterlockedIncrement( &object->refcount );
@@ -2018,14 +2040,22 @@ static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
     if (object->type == TP_OBJECT_TYPE_WAIT && signaled)
         object->u.wait.signaled++;
 
-    /* No new thread started - wake up one existing thread. */
-    if (status != STATUS_SUCCESS)
+    RtlLeaveCriticalSection( &pool->cs );
+
+    if (new_worker && (status = tp_start_worker_thread( pool )))
     {
+        RtlEnterCriticalSection( &pool->cs );
+        pool->num_workers--;
+        InterlockedDecrement( &pool->refcount );
         assert( pool->num_workers > 0 );
-        RtlWakeConditionVariable( &pool->update_event );
+        RtlLeaveCriticalSection( &pool->cs );
     }
 
-    RtlLeaveCriticalSection( &pool->cs );
+    /* No new thread started - wake up one existing thread. The wakeup is
+     * done outside of the critical section, so that the woken thread
+     * doesn't immediately block on it. */
+    if (status != STATUS_SUCCESS)
+        RtlWakeConditionVariable( &pool->update_event );
 }
 
 /***********************************************************************
@@ -239,6 +239,20 @@ static const unsigned int dir_data_names_initial_size  = 64;
 static struct dir_data **dir_data_cache;
 static unsigned int dir_data_cache_size;
 
+/* result of a case-insensitive file search, valid until the directory is modified */
+struct dir_lookup
+{
+    struct file_identity id;                            /* directory identity */
+    struct timespec      mtime;                         /* directory modification time */
+    unsigned int         len;                           /* length of the name, 0 if unused */
+    WCHAR                name[MAX_DIR_ENTRY_LEN];       /* name searched for */
+    char                 unix_name[MAX_DIR_ENTRY_LEN + 1];  /* name found, empty if none */
+};
+
+#define DIR_LOOKUP_CACHE_SIZE 256
+static struct dir_lookup *dir_lookup_cache;
+static pthread_mutex_t dir_lookup_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 static BOOL show_dot_files;
 static mode_t start_umask;
 
@@ -1770,7 +1784,9 @@ static NTSTATUS fd_set_file_info( int fd, UINT attr, BOOL force_set_xattr )
 
 
 /* get the stat info and file attributes for a file (by name) */
-static int get_file_info( const char *path, struct stat *st, ULONG *attr, ULONG *reparse_tag )
+/* parent is the identity of the directory containing path, if already known */
+static int get_file_info_in_dir( const char *path, const struct file_identity *parent,
+                                 struct stat *st, ULONG *attr, ULONG *reparse_tag )
 {
     char buffer[MAXIMUM_REPARSE_DATA_BUFFER_SIZE];
     size_t len = strlen( path );
@@ -1792,6 +1808,15 @@ static int get_file_info( const char *path, struct stat *st, ULONG *attr, ULONG
             if (reparse_tag) *reparse_tag = IO_REPARSE_TAG_LX_SYMLINK;
         }
     }
+    else if (S_ISDIR( st->st_mode ) && parent)
+    {
+        /* consider mount points to be reparse points (IO_REPARSE_TAG_MOUNT_POINT) */
+        if (st->st_dev != parent->dev || st->st_ino == parent->ino)
+        {
+            *attr |= FILE_ATTRIBUTE_REPARSE_POINT;
+            if (reparse_tag) *reparse_tag = IO_REPARSE_TAG_MOUNT_POINT;
+        }
+    }
     else if (S_ISDIR( st->st_mode ) && (parent_path = malloc( len + 4 )))
     {
         struct stat parent_st;
@@ -1838,6 +1863,13 @@ static int get_file_info( const char *path, struct stat *st, ULONG *attr, ULONG
 }
 
 
+/* get the stat info and file attributes for a file (by name) */
+static int get_file_info( const char *path, struct stat *st, ULONG *attr, ULONG *reparse_tag )
+{
+    return get_file_info_in_dir( path, NULL, st, attr, reparse_tag );
+}
+
+
 #if defined(__ANDROID__) && !defined(HAVE_FUTIMENS)
 static int futimens( int fd, const struct timespec spec[2] )
 {
@@ -2422,11 +2454,18 @@ static NTSTATUS get_dir_data_entry( struct dir_data *dir_data, void *info_ptr, I
                                     union file_directory_info **last_info )
 {
     const struct dir_data_names *names = &dir_data->names[dir_data->pos];
+    BOOL is_dot = !strcmp( names->unix_name, "." ) || !strcmp( names->unix_name, ".." );
     union file_directory_info *info;
     struct stat st;
-    ULONG name_len, start, dir_size, attributes, reparse_tag;
+    ULONG name_len, start, dir_size, attributes = 0, reparse_tag = 0;
+    int ret;
 
-    if (get_file_info( names->unix_name, &st, &attributes, &reparse_tag ) == -1)
+    /* only names are returned, so the attributes and reparse data aren't needed */
+    if (class == FileNamesInformation) ret = stat( names->unix_name, &st );
+    /* the directory is the parent of the entries, so it doesn't need to be looked up again */
+    else ret = get_file_info_in_dir( names->unix_name, is_dot ? NULL : &dir_data->id,
+                                     &st, &attributes, &reparse_tag );
+    if (ret == -1)
     {
         TRACE( "file no longer exists %s\n", debugstr_a(names->unix_name) );
         return STATUS_SUCCESS;
@@ -2944,35 +2983,112 @@ NTSTATUS WINAPI NtQueryDirectoryFile( HANDLE handle, HANDLE event, PIO_APC_ROUTI
 
 
 /***********************************************************************
- *           find_file_in_dir
+ *           get_dir_lookup
  *
- * Find a file in a directory the hard way, by doing a case-insensitive search.
- * The file found is appended to unix_name at pos.
- * There must be at least MAX_DIR_ENTRY_LEN+2 chars available at pos.
+ * Find the lookup cache entry for a name in a directory.
+ * dir_lookup_mutex must be held by caller.
  */
-static NTSTATUS find_file_in_dir( int root_fd, char *unix_name, int pos, const WCHAR *name, int length,
-                                  BOOLEAN check_case )
+static struct dir_lookup *get_dir_lookup( const struct stat *st, const WCHAR *name, int length )
 {
-    WCHAR buffer[MAX_DIR_ENTRY_LEN];
-    BOOLEAN is_name_8_dot_3;
-    DIR *dir;
-    struct dirent *de;
-    struct stat st;
-    int fd, ret;
+    unsigned int i, hash = 2166136261u;
 
-    /* try a shortcut for this directory */
+    if (!dir_lookup_cache && !(dir_lookup_cache = calloc( DIR_LOOKUP_CACHE_SIZE, sizeof(*dir_lookup_cache) )))
+        return NULL;
 
-    unix_name[pos++] = '/';
-    ret = ntdll_wcstoumbs( name, length, unix_name + pos, MAX_DIR_ENTRY_LEN + 1, TRUE );
-    if (ret >= 0 && ret <= MAX_DIR_ENTRY_LEN)
+    hash = (hash ^ (unsigned int)st->st_dev) * 16777619;
+    hash = (hash ^ (unsigned int)st->st_ino) * 16777619;
+    for (i = 0; i < length; i++) hash = (hash ^ towupper( name[i] )) * 16777619;
+    return &dir_lookup_cache[hash % DIR_LOOKUP_CACHE_SIZE];
+}
+
+
+/***********************************************************************
+ *           get_dir_mtime
+ */
+static void get_dir_mtime( const struct stat *st, struct timespec *mtime )
+{
+    mtime->tv_sec = st->st_mtime;
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    mtime->tv_nsec = st->st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    mtime->tv_nsec = st->st_mtimespec.tv_nsec;
+#else
+    mtime->tv_nsec = 0;
+#endif
+}
+
+
+/***********************************************************************
+ *           find_cached_dir_lookup
+ *
+ * Check the result of a previous case-insensitive search for the same name in an
+ * unmodified directory. Returns STATUS_MORE_PROCESSING_REQUIRED if there is none.
+ */
+static NTSTATUS find_cached_dir_lookup( const struct stat *st, const WCHAR *name, int length, char *unix_name )
+{
+    NTSTATUS status = STATUS_MORE_PROCESSING_REQUIRED;
+    struct dir_lookup *lookup;
+    struct timespec mtime;
+
+    get_dir_mtime( st, &mtime );
+    mutex_lock( &dir_lookup_mutex );
+    if ((lookup = get_dir_lookup( st, name, length )) && lookup->len == length &&
+        lookup->id.dev == st->st_dev && lookup->id.ino == st->st_ino &&
+        lookup->mtime.tv_sec == mtime.tv_sec && lookup->mtime.tv_nsec == mtime.tv_nsec &&
+        !wcsnicmp( lookup->name, name, length ))
     {
-        unix_name[pos + ret] = 0;
-        if (!fstatat( root_fd, unix_name, &st, 0 )) return STATUS_SUCCESS;
+        if (!lookup->unix_name[0]) status = STATUS_OBJECT_NAME_NOT_FOUND;
+        else
+        {
+            strcpy( unix_name, lookup->unix_name );
+            status = STATUS_SUCCESS;
+        }
     }
-    if (check_case) goto not_found;  /* we want an exact match */
+    mutex_unlock( &dir_lookup_mutex );
+    return status;
+}
 
-    if (pos > 1) unix_name[pos - 1] = 0;
-    else unix_name[1] = 0;  /* keep the initial slash */
+
+/***********************************************************************
+ *           cache_dir_lookup
+ *
+ * Remember the result of a case-insensitive search; unix_name is NULL if nothing was found.
+ */
+static void cache_dir_lookup( const struct stat *st, const WCHAR *name, int length, const char *unix_name )
+{
+    struct dir_lookup *lookup;
+
+    /* the modification time may not change if the directory gets modified again within
+     * the timestamp granularity, so don't trust it for recently modified directories */
+    if (st->st_mtime + 2 > time( NULL )) return;
+
+    mutex_lock( &dir_lookup_mutex );
+    if ((lookup = get_dir_lookup( st, name, length )))
+    {
+        lookup->id.dev = st->st_dev;
+        lookup->id.ino = st->st_ino;
+        get_dir_mtime( st, &lookup->mtime );
+        lookup->len = length;
+        memcpy( lookup->name, name, length * sizeof(WCHAR) );
+        strcpy( lookup->unix_name, unix_name ? unix_name : "" );
+    }
+    mutex_unlock( &dir_lookup_mutex );
+}
+
+
+/***********************************************************************
+ *           scan_dir_for_file
+ *
+ * Helper for find_file_in_dir, search the directory entries.
+ * unix_name contains the directory name, the file found is appended at pos.
+ */
+static NTSTATUS scan_dir_for_file( int root_fd, char *unix_name, int pos, const WCHAR *name, int length )
+{
+    WCHAR buffer[MAX_DIR_ENTRY_LEN];
+    BOOLEAN is_name_8_dot_3;
+    DIR *dir;
+    struct dirent *de;
+    int fd, ret;
 
     /* check if it fits in 8.3 so that we don't look for short names if we won't need them */
 
@@ -3073,6 +3189,57 @@ not_found:
 }
 
 
+/***********************************************************************
+ *           find_file_in_dir
+ *
+ * Find a file in a directory the hard way, by doing a case-insensitive search.
+ * The file found is appended to unix_name at pos.
+ * There must be at least MAX_DIR_ENTRY_LEN+2 chars available at pos.
+ */
+static NTSTATUS find_file_in_dir( int root_fd, char *unix_name, int pos, const WCHAR *name, int length,
+                                  BOOLEAN check_case )
+{
+    NTSTATUS status;
+    struct stat st;
+    int ret;
+
+    /* try a shortcut for this directory */
+
+    unix_name[pos++] = '/';
+    ret = ntdll_wcstoumbs( name, length, unix_name + pos, MAX_DIR_ENTRY_LEN + 1, TRUE );
+    if (ret >= 0 && ret <= MAX_DIR_ENTRY_LEN)
+    {
+        unix_name[pos + ret] = 0;
+        if (!fstatat( root_fd, unix_name, &st, 0 )) return STATUS_SUCCESS;
+    }
+    if (check_case)  /* we want an exact match */
+    {
+        unix_name[pos - 1] = 0;
+        return STATUS_OBJECT_NAME_NOT_FOUND;
+    }
+
+    if (pos > 1) unix_name[pos - 1] = 0;
+    else unix_name[1] = 0;  /* keep the initial slash */
+
+    /* a previous search in the same unmodified directory gives the same result;
+     * names longer than a cache entry are never cached */
+
+    if (length > MAX_DIR_ENTRY_LEN || fstatat( root_fd, unix_name, &st, 0 ) == -1)
+        return scan_dir_for_file( root_fd, unix_name, pos, name, length );
+
+    if ((status = find_cached_dir_lookup( &st, name, length, unix_name + pos )) != STATUS_MORE_PROCESSING_REQUIRED)
+    {
+        unix_name[pos - 1] = status ? 0 : '/';
+        return status;
+    }
+
+    status = scan_dir_for_file( root_fd, unix_name, pos, name, length );
+    if (!status) cache_dir_lookup( &st, name, length, unix_name + pos );
+    else if (status == STATUS_OBJECT_NAME_NOT_FOUND) cache_dir_lookup( &st, name, length, NULL );
+    return status;
+}
+
+
 #ifndef _WIN64
 
 static const WCHAR catrootW[] = {'s','y','s','t','e','m','3','2','\\','c','a','t','r','o','o','t',0};
@@ -4560,9 +4727,13 @@ NTSTATUS open_unix_file( HANDLE *handle, const char *unix_name, ACCESS_MASK acce
     struct object_attributes *objattr;
     unsigned int status;
     data_size_t len;
+    sigset_t sigset;
 
     if ((status = alloc_object_attributes( attr, &objattr, &len ))) return status;
 
+    /* nearly every file handle ends up needing its unix fd, so have the server send it
+     * along with the reply; fd_cache_mutex keeps other threads from receiving it */
+    server_enter_uninterrupted_section( &fd_cache_mutex, &sigset );
     SERVER_START_REQ( create_file )
     {
         req->access     = access;
@@ -4570,12 +4741,16 @@ NTSTATUS open_unix_file( HANDLE *handle, const char *unix_name, ACCESS_MASK acce
         req->create     = disposition;
         req->options    = options;
         req->attrs      = attributes;
+        req->want_fd    = 1;
         wine_server_add_data( req, objattr, len );
         wine_server_add_data( req, unix_name, strlen(unix_name) );
-        status = wine_server_call( req );
+        status = server_call_unlocked( req );
         *handle = wine_server_ptr_handle( reply->handle );
+        if (!status && reply->fd_type != FD_TYPE_INVALID)
+            server_cache_received_fd( *handle, reply->fd_type, reply->fd_access, reply->fd_options );
     }
     SERVER_END_REQ;
+    server_leave_uninterrupted_section( &fd_cache_mutex, &sigset );
     free( objattr );
     return status;
 }
@@ -272,12 +272,35 @@ static void read_reply_data( void *buffer, size_t size )
  *           wait_reply
  *
  * Wait for a reply from the server.
+ * The reply header and data are usually received with a single read.
  */
 static inline unsigned int wait_reply( struct __server_request_info *req )
 {
-    read_reply_data( &req->u.reply, sizeof(req->u.reply) );
-    if (req->u.reply.reply_header.reply_size)
-        read_reply_data( req->reply_data, req->u.reply.reply_header.reply_size );
+    struct iovec vec[2];
+    data_size_t size;
+    ssize_t ret;
+
+    vec[0].iov_base = &req->u.reply;
+    vec[0].iov_len  = sizeof(req->u.reply);
+    vec[1].iov_base = req->reply_data;
+    vec[1].iov_len  = req->u.req.request_header.reply_size;
+
+    for (;;)
+    {
+        if ((ret = readv( ntdll_get_thread_data()->reply_fd, vec, vec[1].iov_len ? 2 : 1 )) > 0) break;
+        /* the server closed the connection; time to die... */
+        if (!ret || errno == EPIPE) abort_thread(0);
+        if (errno != EINTR) server_protocol_perror("read");
+    }
+
+    if (ret < sizeof(req->u.reply))
+    {
+        read_reply_data( (char *)&req->u.reply + ret, sizeof(req->u.reply) - ret );
+        ret = sizeof(req->u.reply);
+    }
+    size = ret - sizeof(req->u.reply);
+    if (size < req->u.reply.reply_header.reply_size)
+        read_reply_data( (char *)req->reply_data + size, req->u.reply.reply_header.reply_size - size );
     return req->u.reply.reply_header.error;
 }
 
@@ -1056,6 +1079,11 @@ C_ASSERT( sizeof(union fd_cache_entry) == sizeof(LONG64) );
 static union fd_cache_entry *fd_cache[FD_CACHE_ENTRIES];
 static union fd_cache_entry fd_cache_initial_block[FD_CACHE_BLOCK_SIZE];
 
+/* fd cache statistics, only collected and dumped at process exit with +server */
+static LONG fd_cache_hits;      /* lookups answered from the cache */
+static LONG fd_cache_misses;    /* lookups that needed a get_handle_fd request */
+static LONG fd_cache_uncached;  /* misses that returned an fd that couldn't be cached */
+
 static inline unsigned int handle_to_index( HANDLE handle, unsigned int *entry )
 {
     unsigned int idx = (wine_server_obj_handle(handle) >> 2) - 1;
@@ -1166,12 +1194,21 @@ int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
     wanted_access &= FILE_READ_DATA | FILE_WRITE_DATA | FILE_APPEND_DATA;
 
     ret = get_cached_fd( handle, &fd, type, &access, options );
-    if (ret != STATUS_INVALID_HANDLE) goto done;
+    if (ret != STATUS_INVALID_HANDLE)
+    {
+        if (TRACE_ON(server)) InterlockedIncrement( &fd_cache_hits );
+        goto done;
+    }
 
     server_enter_uninterrupted_section( &fd_cache_mutex, &sigset );
     ret = get_cached_fd( handle, &fd, type, &access, options );
-    if (ret == STATUS_INVALID_HANDLE)
+    if (ret != STATUS_INVALID_HANDLE)
+    {
+        if (TRACE_ON(server)) InterlockedIncrement( &fd_cache_hits );
+    }
+    else
     {
+        if (TRACE_ON(server)) InterlockedIncrement( &fd_cache_misses );
         SERVER_START_REQ( get_handle_fd )
         {
             req->handle = wine_server_obj_handle( handle );
@@ -1186,6 +1223,7 @@ int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
                     *needs_close = (!reply->cacheable ||
                                     !add_fd_to_cache( handle, fd, reply->type,
                                                       reply->access, reply->options ));
+                    if (*needs_close && TRACE_ON(server)) InterlockedIncrement( &fd_cache_uncached );
                 }
                 else ret = STATUS_TOO_MANY_OPENED_FILES;
             }
@@ -1209,6 +1247,24 @@ done:
 }
 
 
+/***********************************************************************
+ *           server_cache_received_fd
+ *
+ * Receive the fd that the server sent along with the reply for a newly opened handle,
+ * and add it to the cache. Caller must hold fd_cache_mutex across the server call.
+ */
+void server_cache_received_fd( HANDLE handle, enum server_fd_type type, unsigned int access,
+                               unsigned int options )
+{
+    obj_handle_t fd_handle;
+    int fd;
+
+    if ((fd = wine_server_receive_fd( &fd_handle )) == -1) return;
+    assert( wine_server_ptr_handle(fd_handle) == handle );
+    if (!add_fd_to_cache( handle, fd, type, access, options )) close( fd );
+}
+
+
 /***********************************************************************
  *           wine_server_fd_to_handle
  */
@@ -1580,6 +1636,8 @@ static int init_thread_pipe(void)
  */
 void process_exit_wrapper( int status )
 {
+    TRACE( "fd cache: %d hits, %d misses, %d uncached\n",
+           (int)fd_cache_hits, (int)fd_cache_misses, (int)fd_cache_uncached );
     close( fd_socket );
     exit( status );
 }
@@ -28,6 +28,9 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
+#ifdef HAVE_SYS_SENDFILE_H
+# include <sys/sendfile.h>
+#endif
 #include <unistd.h>
 #ifdef HAVE_IFADDRS_H
 # include <ifaddrs.h>
@@ -117,7 +120,7 @@ struct async_recv_ioctl
     unsigned int *ret_flags;
     int unix_flags;
     unsigned int count;
-    BOOL icmp_over_dgram;
+    int icmp_over_dgram;        /* -1 if not known yet */
     struct iovec iov[1];
 };
 
@@ -131,6 +134,7 @@ struct async_send_ioctl
     unsigned int count;
     unsigned int iov_cursor;
     int fd;
+    int sock_type;
     struct iovec iov[1];
 };
 
@@ -152,6 +156,7 @@ struct async_transmit_ioctl
     unsigned int head_len;
     unsigned int tail_len;
     LARGE_INTEGER offset;
+    BOOL use_sendfile;          /* file data may be sent directly with sendfile() */
 };
 
 static NTSTATUS sock_errno_to_status( int err )
@@ -784,6 +789,23 @@ static ssize_t fixup_icmp_over_dgram( struct msghdr *hdr, union unix_sockaddr *u
     return recv_len;
 }
 
+static BOOL is_icmp_over_dgram( int fd )
+{
+#ifdef linux
+    socklen_t len;
+    int val;
+
+    len = sizeof(val);
+    if (getsockopt( fd, SOL_SOCKET, SO_PROTOCOL, (char *)&val, &len ) || (val != IPPROTO_ICMP && val != IPPROTO_ICMPV6))
+        return FALSE;
+
+    len = sizeof(val);
+    return !getsockopt( fd, SOL_SOCKET, SO_TYPE, (char *)&val, &len ) && val == SOCK_DGRAM;
+#else
+    return FALSE;
+#endif
+}
+
 static NTSTATUS try_recv( int fd, struct async_recv_ioctl *async, ULONG_PTR *size )
 {
     char control_buffer[512];
@@ -792,6 +814,9 @@ static NTSTATUS try_recv( int fd, struct async_recv_ioctl *async, ULONG_PTR *siz
     NTSTATUS status;
     ssize_t ret;
 
+    if (async->icmp_over_dgram == -1)
+        async->icmp_over_dgram = is_icmp_over_dgram( fd );
+
     memset( &hdr, 0, sizeof(hdr) );
     if (async->addr || async->icmp_over_dgram)
     {
@@ -895,28 +920,11 @@ static BOOL async_recv_proc( void *user, ULONG_PTR *info, unsigned int *status )
     return TRUE;
 }
 
-static BOOL is_icmp_over_dgram( int fd )
-{
-#ifdef linux
-    socklen_t len;
-    int val;
-
-    len = sizeof(val);
-    if (getsockopt( fd, SOL_SOCKET, SO_PROTOCOL, (char *)&val, &len ) || (val != IPPROTO_ICMP && val != IPPROTO_ICMPV6))
-        return FALSE;
-
-    len = sizeof(val);
-    return !getsockopt( fd, SOL_SOCKET, SO_TYPE, (char *)&val, &len ) && val == SOCK_DGRAM;
-#else
-    return FALSE;
-#endif
-}
-
 static NTSTATUS sock_recv( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, void *apc_user, IO_STATUS_BLOCK *io,
                            int fd, struct async_recv_ioctl *async, int force_async )
 {
     HANDLE wait_handle;
-    BOOL nonblocking;
+    BOOL nonblocking, icmp_over_dgram;
     unsigned int i, status;
     ULONG options;
 
@@ -938,6 +946,7 @@ static NTSTATUS sock_recv( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, voi
         wait_handle = wine_server_ptr_handle( reply->wait );
         options     = reply->options;
         nonblocking = reply->nonblocking;
+        icmp_over_dgram = reply->icmp_over_dgram;
     }
     SERVER_END_REQ;
 
@@ -948,6 +957,8 @@ static NTSTATUS sock_recv( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, voi
     {
         ULONG_PTR information;
 
+        /* the async can't be woken up before we complete it, so it's safe to update it */
+        async->icmp_over_dgram = icmp_over_dgram;
         status = try_recv( fd, async, &information );
         if (status == STATUS_DEVICE_NOT_READY && (force_async || !nonblocking))
             status = STATUS_PENDING;
@@ -1009,7 +1020,7 @@ static NTSTATUS sock_ioctl_recv( HANDLE handle, HANDLE event, PIO_APC_ROUTINE ap
     async->addr = addr;
     async->addr_len = addr_len;
     async->ret_flags = ret_flags;
-    async->icmp_over_dgram = is_icmp_over_dgram( fd );
+    async->icmp_over_dgram = -1;
 
     return sock_recv( handle, event, apc, apc_user, io, fd, async, force_async );
 }
@@ -1032,7 +1043,7 @@ NTSTATUS sock_read( HANDLE handle, int fd, HANDLE event, PIO_APC_ROUTINE apc,
     async->addr = NULL;
     async->addr_len = NULL;
     async->ret_flags = NULL;
-    async->icmp_over_dgram = is_icmp_over_dgram( fd );
+    async->icmp_over_dgram = -1;
 
     return sock_recv( handle, event, apc, apc_user, io, fd, async, 1 );
 }
@@ -1043,14 +1054,18 @@ static NTSTATUS try_send( int fd, struct async_send_ioctl *async )
     union unix_sockaddr unix_addr;
     struct msghdr hdr;
     int attempt = 0;
-    int sock_type;
-    socklen_t len = sizeof(sock_type);
     ssize_t ret;
 
-    getsockopt(fd, SOL_SOCKET, SO_TYPE, &sock_type, &len);
+    /* the socket type only matters for explicit destination addresses, and
+     * does not change between retries of the same async */
+    if (async->addr && !async->sock_type)
+    {
+        socklen_t len = sizeof(async->sock_type);
+        getsockopt( fd, SOL_SOCKET, SO_TYPE, &async->sock_type, &len );
+    }
 
     memset( &hdr, 0, sizeof(hdr) );
-    if (async->addr && sock_type != SOCK_STREAM)
+    if (async->addr && async->sock_type != SOCK_STREAM)
     {
         hdr.msg_name = &unix_addr;
         hdr.msg_namelen = sockaddr_to_unix( async->addr, async->addr_len, &unix_addr );
@@ -1059,7 +1074,7 @@ static NTSTATUS try_send( int fd, struct async_send_ioctl *async )
             ERR( "failed to convert address\n" );
             return STATUS_ACCESS_VIOLATION;
         }
-        if (sock_type == SOCK_DGRAM && ((unix_addr.addr.sa_family == AF_INET && !unix_addr.in.sin_port)
+        if (async->sock_type == SOCK_DGRAM && ((unix_addr.addr.sa_family == AF_INET && !unix_addr.in.sin_port)
             || (unix_addr.addr.sa_family == AF_INET6 && !unix_addr.in6.sin6_port)))
         {
             /* Sending to port 0 succeeds on Windows. Use 'discard' service instead so sendmsg() works on Unix
@@ -1183,9 +1198,10 @@ static NTSTATUS sock_send( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, voi
                            IO_STATUS_BLOCK *io, int fd, struct async_send_ioctl *async, unsigned int server_flags )
 {
     HANDLE wait_handle;
-    BOOL nonblocking;
+    BOOL nonblocking, icmp_over_dgram;
     unsigned int status;
     ULONG options;
+    int unix_type;
 
     SERVER_START_REQ( send_socket )
     {
@@ -1195,17 +1211,21 @@ static NTSTATUS sock_send( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, voi
         wait_handle = wine_server_ptr_handle( reply->wait );
         options     = reply->options;
         nonblocking = reply->nonblocking;
+        unix_type   = reply->unix_type;
+        icmp_over_dgram = reply->icmp_over_dgram;
     }
     SERVER_END_REQ;
 
     /* the server currently will never succeed immediately */
     assert(status == STATUS_ALERTED || status == STATUS_PENDING || NT_ERROR(status));
 
-    if (!NT_ERROR(status) && is_icmp_over_dgram( fd ))
+    if (!NT_ERROR(status) && icmp_over_dgram)
         sock_save_icmp_id( async );
 
     if (status == STATUS_ALERTED)
     {
+        /* the async can't be woken up before we complete it, so it's safe to update it */
+        if (unix_type) async->sock_type = unix_type;
         status = try_send( fd, async );
         if (status == STATUS_DEVICE_NOT_READY && ((server_flags & SERVER_SOCKET_IO_FORCE_ASYNC) || !nonblocking))
             status = STATUS_PENDING;
@@ -1255,6 +1275,7 @@ static NTSTATUS sock_send( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc, voi
                 rem_async->addr = (const struct WS_sockaddr *)p;
                 p += addr_size;
                 rem_async->addr_len = async->addr_len;
+                rem_async->sock_type = async->sock_type;
                 rem_async->iov_cursor = 0;
                 rem_async->sent_len = 0;
                 rem_io = (IO_STATUS_BLOCK *)p;
@@ -1326,6 +1347,7 @@ static NTSTATUS sock_ioctl_send( HANDLE handle, HANDLE event, PIO_APC_ROUTINE ap
     async->addr_len = addr_len;
     async->iov_cursor = 0;
     async->sent_len = 0;
+    async->sock_type = 0;
 
     return sock_send( handle, event, apc, apc_user, io, fd, async, force_async ? SERVER_SOCKET_IO_FORCE_ASYNC : 0 );
 }
@@ -1349,6 +1371,7 @@ NTSTATUS sock_write( HANDLE handle, int fd, HANDLE event, PIO_APC_ROUTINE apc,
     async->addr_len = 0;
     async->iov_cursor = 0;
     async->sent_len = 0;
+    async->sock_type = 0;
 
     return sock_send( handle, event, apc, apc_user, io, fd, async, SERVER_SOCKET_IO_FORCE_ASYNC );
 }
@@ -1387,6 +1410,42 @@ static NTSTATUS try_transmit( int sock_fd, int file_fd, struct async_transmit_io
         async->file_cursor += ret;
     }
 
+#ifdef HAVE_SYS_SENDFILE_H
+    while (async->file && async->use_sendfile && async->buffer_cursor == async->read_len)
+    {
+        size_t count = 0x7ffff000; /* maximum transfer size of a single sendfile() call */
+        off_t offset = async->offset.QuadPart;
+
+        if (async->file_len)
+            count = min( count, async->file_len - async->file_cursor );
+
+        TRACE( "sending up to %zu bytes of file data with sendfile\n", count );
+        do
+        {
+            if (async->offset.QuadPart == FILE_USE_FILE_POINTER_POSITION)
+                ret = sendfile( sock_fd, file_fd, NULL, count );
+            else
+                ret = sendfile( sock_fd, file_fd, &offset, count );
+        } while (ret < 0 && errno == EINTR);
+        if (ret < 0)
+        {
+            if (errno != EINVAL && errno != ENOSYS) return sock_errno_to_status( errno );
+            /* the file can't be mapped for sendfile(), fall back to copying it */
+            TRACE( "sendfile failed: %s\n", strerror( errno ) );
+            async->use_sendfile = FALSE;
+            break;
+        }
+        TRACE( "sendfile returned %zd\n", ret );
+
+        async->file_cursor += ret;
+        if (async->offset.QuadPart != FILE_USE_FILE_POINTER_POSITION)
+            async->offset.QuadPart += ret;
+
+        if (!ret || (async->file_len && async->file_cursor == async->file_len))
+            async->file = NULL;
+    }
+#endif
+
     if (async->file && async->buffer_cursor == async->read_len)
     {
         unsigned int read_size = async->buffer_size;
@@ -1511,6 +1570,7 @@ static NTSTATUS sock_transmit( HANDLE handle, HANDLE event, PIO_APC_ROUTINE apc,
     async->tail = u64_to_user_ptr(params->tail_ptr);
     async->tail_len = params->tail_len;
     async->offset = params->offset;
+    async->use_sendfile = TRUE;
 
     SERVER_START_REQ( send_socket )
     {
@@ -2873,9 +2873,10 @@ NTSTATUS WINAPI NtRemoveIoCompletion( HANDLE handle, ULONG_PTR *key, ULONG_PTR *
 NTSTATUS WINAPI NtRemoveIoCompletionEx( HANDLE handle, FILE_IO_COMPLETION_INFORMATION *info, ULONG count,
                                         ULONG *written, LARGE_INTEGER *timeout, BOOLEAN alertable )
 {
+    struct completion_packet packets[64];
     HANDLE wait_handle = NULL;
     unsigned int status;
-    ULONG i = 0;
+    ULONG i = 0, j, max, received = 0;
 
     TRACE( "%p %p %u %p %p %u\n", handle, info, count, written, timeout, alertable );
 
@@ -2883,22 +2884,37 @@ NTSTATUS WINAPI NtRemoveIoCompletionEx( HANDLE handle, FILE_IO_COMPLETION_INFORM
 
     while (i < count)
     {
+        /* the server returns the following queued completions in the reply data */
+        max = min( count - i - 1, ARRAY_SIZE(packets) );
+
         SERVER_START_REQ( remove_completion )
         {
             req->handle = wine_server_obj_handle( handle );
             req->alertable = alertable;
+            wine_server_set_reply( req, packets, max * sizeof(*packets) );
             if (!(status = wine_server_call( req )))
             {
                 info[i].CompletionKey             = reply->ckey;
                 info[i].CompletionValue           = reply->cvalue;
                 info[i].IoStatusBlock.Information = reply->information;
                 info[i].IoStatusBlock.Status      = reply->status;
+                received = wine_server_reply_size( reply ) / sizeof(*packets);
             }
             else wait_handle = wine_server_ptr_handle( reply->wait_handle );
         }
         SERVER_END_REQ;
         if (status != STATUS_SUCCESS) break;
         ++i;
+
+        for (j = 0; j < received; j++, i++)
+        {
+            info[i].CompletionKey             = packets[j].ckey;
+            info[i].CompletionValue           = packets[j].cvalue;
+            info[i].IoStatusBlock.Information = packets[j].information;
+            info[i].IoStatusBlock.Status      = packets[j].status;
+        }
+        /* the queue is empty if the reply buffer wasn't filled */
+        if (received < max) break;
     }
     if (i || (status != STATUS_PENDING && status != STATUS_USER_APC))
     {
@@ -1302,6 +1302,134 @@ static void test_poll_exclusive(void)
 #undef POLL_SOCK_CNT
 #undef POLL_CNT
 
+#define POLL_MANY_CNT 1000
+
+static void test_poll_many(void)
+{
+    const struct sockaddr_in bind_addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    const ULONG params_size = offsetof(struct afd_poll_params, sockets[1]);
+    const ULONG big_params_size = offsetof(struct afd_poll_params, sockets[POLL_MANY_CNT]);
+    struct afd_poll_params *in_params, *out_params, *big_in_params, *big_out_params;
+    struct sockaddr_in *addrs;
+    SOCKET ctl_sock, sender, *socks;
+    IO_STATUS_BLOCK *io, big_io;
+    HANDLE *events, big_event;
+    DWORD ticks;
+    int ret, len;
+    unsigned int i;
+
+    socks = malloc(POLL_MANY_CNT * sizeof(*socks));
+    addrs = malloc(POLL_MANY_CNT * sizeof(*addrs));
+    events = malloc(POLL_MANY_CNT * sizeof(*events));
+    io = malloc(POLL_MANY_CNT * sizeof(*io));
+    in_params = malloc(params_size);
+    out_params = malloc(POLL_MANY_CNT * params_size);
+    big_in_params = malloc(big_params_size);
+    big_out_params = malloc(big_params_size);
+
+    ctl_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    sender = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+    for (i = 0; i < POLL_MANY_CNT; ++i)
+    {
+        socks[i] = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        ok(socks[i] != INVALID_SOCKET, "got error %u\n", WSAGetLastError());
+        ret = bind(socks[i], (const struct sockaddr *)&bind_addr, sizeof(bind_addr));
+        ok(!ret, "got error %u\n", WSAGetLastError());
+        len = sizeof(addrs[i]);
+        ret = getsockname(socks[i], (struct sockaddr *)&addrs[i], &len);
+        ok(!ret, "got error %u\n", WSAGetLastError());
+        events[i] = CreateEventW(NULL, TRUE, FALSE, NULL);
+    }
+
+    /* One pending poll per socket; waking one must not complete the others. */
+
+    in_params->timeout = TIMEOUT_INFINITE;
+    in_params->count = 1;
+    in_params->exclusive = FALSE;
+    for (i = 0; i < POLL_MANY_CNT; ++i)
+    {
+        in_params->sockets[0].socket = socks[i];
+        in_params->sockets[0].flags = AFD_POLL_READ;
+        in_params->sockets[0].status = 0;
+        ret = NtDeviceIoControlFile((HANDLE)ctl_sock, events[i], NULL, NULL, &io[i], IOCTL_AFD_POLL,
+                in_params, params_size, (char *)out_params + i * params_size, params_size);
+        ok(ret == STATUS_PENDING, "got %#x\n", ret);
+    }
+
+    ticks = GetTickCount();
+    for (i = 0; i < POLL_MANY_CNT; ++i)
+    {
+        struct afd_poll_params *out = (struct afd_poll_params *)((char *)out_params + i * params_size);
+
+        ret = sendto(sender, "data", 5, 0, (const struct sockaddr *)&addrs[i], sizeof(addrs[i]));
+        ok(ret == 5, "got %d\n", ret);
+        ret = WaitForSingleObject(events[i], 1000);
+        ok(!ret, "got %#x\n", ret);
+        ok(!io[i].Status, "got %#lx\n", io[i].Status);
+        ok(out->count == 1, "got count %u\n", out->count);
+        ok(out->sockets[0].socket == socks[i], "got socket %#Ix\n", out->sockets[0].socket);
+        ok(out->sockets[0].flags == AFD_POLL_READ, "got flags %#x\n", out->sockets[0].flags);
+        if (i + 1 < POLL_MANY_CNT)
+        {
+            ret = WaitForSingleObject(events[i + 1], 0);
+            ok(ret == WAIT_TIMEOUT, "got %#x\n", ret);
+        }
+    }
+    trace("completed %u single-socket polls in %lu ms\n", POLL_MANY_CNT, GetTickCount() - ticks);
+
+    /* One poll covering all sockets; only the signaled socket must be reported. */
+
+    big_event = CreateEventW(NULL, TRUE, FALSE, NULL);
+    big_in_params->timeout = TIMEOUT_INFINITE;
+    big_in_params->count = POLL_MANY_CNT;
+    big_in_params->exclusive = FALSE;
+    for (i = 0; i < POLL_MANY_CNT; ++i)
+    {
+        char buffer[5];
+
+        ret = recv(socks[i], buffer, sizeof(buffer), 0);
+        ok(ret == 5, "got %d\n", ret);
+        big_in_params->sockets[i].socket = socks[i];
+        big_in_params->sockets[i].flags = AFD_POLL_READ;
+        big_in_params->sockets[i].status = 0;
+    }
+
+    ticks = GetTickCount();
+    ret = NtDeviceIoControlFile((HANDLE)ctl_sock, big_event, NULL, NULL, &big_io, IOCTL_AFD_POLL,
+            big_in_params, big_params_size, big_out_params, big_params_size);
+    ok(ret == STATUS_PENDING, "got %#x\n", ret);
+
+    ret = sendto(sender, "data", 5, 0, (const struct sockaddr *)&addrs[POLL_MANY_CNT - 1], sizeof(addrs[0]));
+    ok(ret == 5, "got %d\n", ret);
+    ret = WaitForSingleObject(big_event, 1000);
+    ok(!ret, "got %#x\n", ret);
+    trace("completed %u-socket poll in %lu ms\n", POLL_MANY_CNT, GetTickCount() - ticks);
+    ok(!big_io.Status, "got %#lx\n", big_io.Status);
+    ok(big_io.Information == offsetof(struct afd_poll_params, sockets[1]), "got %#Ix\n", big_io.Information);
+    ok(big_out_params->count == 1, "got count %u\n", big_out_params->count);
+    ok(big_out_params->sockets[0].socket == socks[POLL_MANY_CNT - 1],
+            "got socket %#Ix\n", big_out_params->sockets[0].socket);
+    ok(big_out_params->sockets[0].flags == AFD_POLL_READ, "got flags %#x\n", big_out_params->sockets[0].flags);
+
+    CloseHandle(big_event);
+    for (i = 0; i < POLL_MANY_CNT; ++i)
+    {
+        closesocket(socks[i]);
+        CloseHandle(events[i]);
+    }
+    closesocket(sender);
+    closesocket(ctl_sock);
+    free(big_out_params);
+    free(big_in_params);
+    free(out_params);
+    free(in_params);
+    free(io);
+    free(events);
+    free(addrs);
+    free(socks);
+}
+
 static void test_poll_completion_port(void)
 {
     struct afd_poll_params params = {0};
@@ -2946,6 +3074,7 @@ START_TEST(afd)
     test_open_device();
     test_poll();
     test_poll_exclusive();
+    test_poll_many();
     test_poll_completion_port();
     test_poll_reset();
     test_recv();
@@ -10135,6 +10135,72 @@ static void test_TransmitFile(void)
     closesocket(server);
 }
 
+static void test_TransmitFile_large(void)
+{
+    GUID transmitFileGuid = WSAID_TRANSMITFILE;
+    LPFN_TRANSMITFILE pTransmitFile = NULL;
+    static const DWORD file_size = 16 * 1024 * 1024;
+    char path[MAX_PATH], filename[MAX_PATH];
+    DWORD num_bytes, i, total, ticks;
+    SOCKET client, dest;
+    WSAOVERLAPPED ov;
+    char *data, *buf;
+    HANDLE file;
+    BOOL bret;
+    int ret;
+
+    tcp_socketpair(&client, &dest);
+    ret = WSAIoctl(client, SIO_GET_EXTENSION_FUNCTION_POINTER, &transmitFileGuid, sizeof(transmitFileGuid),
+                   &pTransmitFile, sizeof(pTransmitFile), &num_bytes, NULL, NULL);
+    ok(!ret, "failed to get TransmitFile, error %u\n", WSAGetLastError());
+
+    data = malloc(file_size);
+    buf = malloc(file_size);
+    for (i = 0; i < file_size; ++i) data[i] = i * 7 + (i >> 12);
+
+    GetTempPathA(sizeof(path), path);
+    GetTempFileNameA(path, "wst", 0, filename);
+    file = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                       FILE_FLAG_DELETE_ON_CLOSE, NULL);
+    ok(file != INVALID_HANDLE_VALUE, "failed to create file, error %lu\n", GetLastError());
+    bret = WriteFile(file, data, file_size, &num_bytes, NULL);
+    ok(bret && num_bytes == file_size, "failed to write file, error %lu\n", GetLastError());
+    SetFilePointer(file, 0, NULL, FILE_BEGIN);
+
+    memset(&ov, 0, sizeof(ov));
+    ov.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+
+    ticks = GetTickCount();
+    bret = pTransmitFile(client, file, 0, 0, &ov, NULL, 0);
+    ok(bret || WSAGetLastError() == ERROR_IO_PENDING, "TransmitFile failed, error %u\n", WSAGetLastError());
+
+    total = 0;
+    while (total < file_size)
+    {
+        ret = recv(dest, buf + total, file_size - total, 0);
+        ok(ret > 0, "recv failed, ret %d, error %u\n", ret, WSAGetLastError());
+        if (ret <= 0) break;
+        total += ret;
+    }
+    ret = WaitForSingleObject(ov.hEvent, 10000);
+    ok(!ret, "wait returned %d\n", ret);
+    ticks = GetTickCount() - ticks;
+
+    bret = WSAGetOverlappedResult(client, &ov, &num_bytes, FALSE, NULL);
+    ok(bret, "TransmitFile failed, error %u\n", WSAGetLastError());
+    ok(num_bytes == file_size, "expected %lu bytes, got %lu\n", file_size, num_bytes);
+    ok(total == file_size, "expected %lu bytes, received %lu\n", file_size, total);
+    ok(!memcmp(buf, data, file_size), "data didn't match\n");
+    trace("transmitted %lu bytes in %lu ms\n", total, ticks);
+
+    CloseHandle(ov.hEvent);
+    CloseHandle(file);
+    closesocket(client);
+    closesocket(dest);
+    free(data);
+    free(buf);
+}
+
 static void test_getpeername(void)
 {
     SOCKET sock;
@@ -14943,6 +15009,7 @@ START_TEST( sock )
 
     test_ipv6only();
     test_TransmitFile();
+    test_TransmitFile_large();
     test_AcceptEx();
     test_connect();
     test_shutdown();
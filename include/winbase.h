@@ -1912,6 +1912,7 @@ WINBASEAPI DWORD       WINAPI GetFullPathNameW(LPCWSTR,DWORD,LPWSTR,LPWSTR*);
 #define                       GetFullPathName WINELIB_NAME_AW(GetFullPathName)
 WINBASEAPI BOOL        WINAPI GetHandleInformation(HANDLE,LPDWORD);
 WINADVAPI  BOOL        WINAPI GetKernelObjectSecurity(HANDLE,SECURITY_INFORMATION,PSECURITY_DESCRIPTOR,DWORD,LPDWORD);
+WINBASEAPI SIZE_T      WINAPI GetLargePageMinimum(void);
 WINADVAPI  DWORD       WINAPI GetLengthSid(PSID);
 WINBASEAPI DWORD       WINAPI GetLogicalDrives(void);
 WINBASEAPI UINT        WINAPI GetLogicalDriveStringsA(UINT,LPSTR);
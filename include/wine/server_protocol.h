@@ -1844,14 +1844,18 @@ struct create_file_request
     int          create;
     unsigned int options;
     unsigned int attrs;
+    int          want_fd;
     /* VARARG(objattr,object_attributes); */
     /* VARARG(filename,string); */
+    char __pad_36[4];
 };
 struct create_file_reply
 {
     struct reply_header __header;
     obj_handle_t handle;
-    char __pad_12[4];
+    int          fd_type;
+    unsigned int fd_access;
+    unsigned int fd_options;
 };
 
 
@@ -2039,7 +2043,7 @@ struct recv_socket_reply
     obj_handle_t wait;
     unsigned int options;
     int          nonblocking;
-    char __pad_20[4];
+    int          icmp_over_dgram;
 };
 
 
@@ -2056,7 +2060,9 @@ struct send_socket_reply
     obj_handle_t wait;
     unsigned int options;
     int          nonblocking;
-    char __pad_20[4];
+    int          unix_type;
+    int          icmp_over_dgram;
+    char __pad_28[4];
 };
 
 #define SERVER_SOCKET_IO_FORCE_ASYNC 0x01
@@ -5511,6 +5517,15 @@ struct add_completion_reply
 };
 
 
+struct completion_packet
+{
+    apc_param_t   ckey;
+    apc_param_t   cvalue;
+    apc_param_t   information;
+    unsigned int  status;
+    int           __pad;
+};
+
 
 struct remove_completion_request
 {
@@ -5527,6 +5542,7 @@ struct remove_completion_reply
     apc_param_t   information;
     unsigned int  status;
     obj_handle_t  wait_handle;
+    /* VARARG(packets,completion_packets); */
 };
 
 
@@ -7093,6 +7109,6 @@ union generic_reply
     struct d3dkmt_mutex_release_reply d3dkmt_mutex_release_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 930
+#define SERVER_PROTOCOL_VERSION 933
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
@@ -408,6 +408,9 @@ DECL_HANDLER(remove_completion)
     }
     else
     {
+        struct completion_packet *packets;
+        data_size_t count;
+
         list_remove( entry );
         completion->depth--;
         msg = LIST_ENTRY( entry, struct comp_msg, queue_entry );
@@ -417,6 +420,27 @@ DECL_HANDLER(remove_completion)
         reply->information = msg->information;
         free( msg );
         reply->wait_handle = 0;
+
+        /* return as many of the following completions as the reply buffer can hold */
+        count = min( get_reply_max_size() / sizeof(*packets), completion->depth );
+        if (count && (packets = set_reply_data_size( count * sizeof(*packets) )))
+        {
+            while (count--)
+            {
+                entry = list_head( &completion->queue );
+                list_remove( entry );
+                completion->depth--;
+                msg = LIST_ENTRY( entry, struct comp_msg, queue_entry );
+                packets->ckey = msg->ckey;
+                packets->cvalue = msg->cvalue;
+                packets->information = msg->information;
+                packets->status = msg->status;
+                packets->__pad = 0;
+                packets++;
+                free( msg );
+            }
+        }
+
         if (list_empty( &completion->queue )) reset_sync( completion->sync );
     }
 
@@ -522,58 +522,118 @@ static inline void fd_poll_event( struct fd *fd, int event )
 
 static int epoll_fd = -1;
 
+/* epoll state of a poll user */
+struct epoll_user
+{
+    int events;   /* events currently registered with epoll, or -1 if not registered */
+    int pending;  /* whether the user is in the pending changes list */
+};
+
+static struct epoll_user *epoll_users;      /* epoll state, indexed like the poll array */
+static int *epoll_pending;                  /* users whose events have changed since the last wait */
+static int nb_epoll_pending;                /* count of entries in the pending list */
+static int allocated_epoll_users;           /* count of allocated entries in the arrays */
+
 static inline void init_epoll(void)
 {
     epoll_fd = epoll_create( 128 );
 }
 
-/* set the events that epoll waits for on this fd; helper for set_fd_events */
-static inline void set_fd_epoll_events( struct fd *fd, int user, int events )
+/* give up on epoll and fall back to poll */
+static void disable_epoll(void)
 {
-    struct epoll_event ev;
-    int ctl;
+    close( epoll_fd );
+    epoll_fd = -1;
+}
 
-    if (epoll_fd == -1) return;
+/* make sure the epoll arrays can hold the specified user */
+static int grow_epoll_users( int user )
+{
+    struct epoll_user *new_users;
+    int *new_pending;
+    int i, new_count = allocated_users;
 
-    if (events == -1)  /* stop waiting on this fd completely */
+    if (user < allocated_epoll_users) return 1;
+
+    if (!(new_users = realloc( epoll_users, new_count * sizeof(*epoll_users) ))) return 0;
+    epoll_users = new_users;
+    if (!(new_pending = realloc( epoll_pending, new_count * sizeof(*epoll_pending) ))) return 0;
+    epoll_pending = new_pending;
+    for (i = allocated_epoll_users; i < new_count; i++)
     {
-        if (pollfd[user].fd == -1) return;  /* already removed */
-        ctl = EPOLL_CTL_DEL;
+        epoll_users[i].events = -1;
+        epoll_users[i].pending = 0;
     }
-    else if (pollfd[user].fd == -1)
+    allocated_epoll_users = new_count;
+    return 1;
+}
+
+/* remove the fd from the epoll set right away, as its unix fd may be closed */
+static void remove_epoll_events( struct fd *fd, int user )
+{
+    struct epoll_event dummy;
+
+    if (user >= allocated_epoll_users || epoll_users[user].events == -1) return;
+    epoll_ctl( epoll_fd, EPOLL_CTL_DEL, fd->unix_fd, &dummy );
+    epoll_users[user].events = -1;
+}
+
+/* set the events that epoll waits for on this fd; helper for set_fd_events
+ * changes other than removal are only recorded here, and applied by flush_epoll_events
+ * before the next wait, so that multiple changes to the same fd cost a single syscall */
+static inline void set_fd_epoll_events( struct fd *fd, int user, int events )
+{
+    if (epoll_fd == -1) return;
+
+    if (events == -1)  /* stop waiting on this fd completely */
     {
-        ctl = EPOLL_CTL_ADD;
+        remove_epoll_events( fd, user );
+        return;
     }
-    else
+    if (!grow_epoll_users( user ))  /* not enough memory, give up on epoll */
     {
-        if (pollfd[user].events == events) return;  /* nothing to do */
-        ctl = EPOLL_CTL_MOD;
+        disable_epoll();
+        return;
     }
+    if (epoll_users[user].pending) return;
+    epoll_users[user].pending = 1;
+    epoll_pending[nb_epoll_pending++] = user;
+}
 
-    ev.events = events;
-    memset(&ev.data, 0, sizeof(ev.data));
-    ev.data.u32 = user;
+/* apply the pending event changes to the epoll set */
+static void flush_epoll_events(void)
+{
+    struct epoll_event ev;
+    int i, user, events, ctl;
 
-    if (epoll_ctl( epoll_fd, ctl, fd->unix_fd, &ev ) == -1)
+    for (i = 0; i < nb_epoll_pending && epoll_fd != -1; i++)
     {
-        if (errno == ENOMEM)  /* not enough memory, give up on epoll */
-        {
-            close( epoll_fd );
-            epoll_fd = -1;
-        }
+        user = epoll_pending[i];
+        if (!epoll_users[user].pending) continue;
+        epoll_users[user].pending = 0;
+
+        if (pollfd[user].fd == -1) continue;  /* removed in the meantime */
+        events = pollfd[user].events;
+        if (events == epoll_users[user].events) continue;  /* nothing to do */
+
+        ctl = epoll_users[user].events == -1 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+        ev.events = events;
+        memset(&ev.data, 0, sizeof(ev.data));
+        ev.data.u32 = user;
+
+        if (epoll_ctl( epoll_fd, ctl, poll_users[user]->unix_fd, &ev ) != -1)
+            epoll_users[user].events = events;
+        else if (errno == ENOMEM)  /* not enough memory, give up on epoll */
+            disable_epoll();
         else perror( "epoll_ctl" );  /* should not happen */
     }
+    nb_epoll_pending = 0;
 }
 
 static inline void remove_epoll_user( struct fd *fd, int user )
 {
-    if (epoll_fd == -1) return;
-
-    if (pollfd[user].fd != -1)
-    {
-        struct epoll_event dummy;
-        epoll_ctl( epoll_fd, EPOLL_CTL_DEL, fd->unix_fd, &dummy );
-    }
+    /* a pending change is left in the list, it will be ignored unless the user is reused */
+    if (epoll_fd != -1) remove_epoll_events( fd, user );
 }
 
 static inline void main_loop_epoll(void)
@@ -597,6 +657,8 @@ static inline void main_loop_epoll(void)
         timeout = get_next_timeout( &ts );
 
         if (!active_users) break;  /* last user removed by a timeout */
+
+        flush_epoll_events();
         if (epoll_fd == -1) break;  /* an error occurred with epoll */
 
 #ifdef HAVE_EPOLL_PWAIT2
@@ -3024,6 +3086,27 @@ void fd_copy_completion( struct fd *src, struct fd *dst )
     dst->comp_flags = src->comp_flags;
 }
 
+/* send the unix fd of a newly opened handle along with the open reply, to save the */
+/* client a get_handle_fd round trip; returns FD_TYPE_INVALID if nothing was sent */
+int send_handle_fd( struct object *obj, obj_handle_t handle, unsigned int *access,
+                    unsigned int *options )
+{
+    struct fd *fd;
+    int type = FD_TYPE_INVALID;
+
+    if (obj->ops->get_fd == no_get_fd || !(fd = get_obj_fd( obj ))) return FD_TYPE_INVALID;
+
+    if (fd->cacheable && fd->unix_fd != -1 &&
+        (type = fd->fd_ops->get_fd_type( fd )) != FD_TYPE_INVALID)
+    {
+        *options = fd->options;
+        *access = get_handle_access( current->process, handle );
+        send_client_fd( current->process, fd->unix_fd, handle );
+    }
+    release_object( fd );
+    return type;
+}
+
 /* flush a file buffers */
 DECL_HANDLER(flush)
 {
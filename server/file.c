@@ -668,6 +668,8 @@ DECL_HANDLER(create_file)
                              req->create, req->options, req->attrs, sd )))
     {
         reply->handle = alloc_handle( current->process, file, req->access, objattr->attributes );
+        if (reply->handle && req->want_fd)
+            reply->fd_type = send_handle_fd( file, reply->handle, &reply->fd_access, &reply->fd_options );
         release_object( file );
     }
     if (root_fd) release_object( root_fd );
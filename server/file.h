@@ -107,6 +107,8 @@ extern void allow_fd_caching( struct fd *fd );
 extern void set_fd_signaled( struct fd *fd, int signaled );
 extern char *dup_fd_name( struct fd *root, const char *name ) __WINE_DEALLOC(free) __WINE_MALLOC;
 extern void get_nt_name( struct fd *fd, struct unicode_str *name );
+extern int send_handle_fd( struct object *obj, obj_handle_t handle, unsigned int *access,
+                           unsigned int *options );
 
 extern struct object *default_fd_get_sync( struct object *obj );
 extern WCHAR *default_fd_get_full_name( struct object *obj, data_size_t max, data_size_t *ret_len );
@@ -57,6 +57,7 @@ struct inproc_sync
     struct object          obj;  /* object header */
     enum inproc_sync_type  type;
     int                    fd;
+    int                    signaled;  /* state of server-only manual-reset events, or -1 if unknown */
     struct list            entry;
 };
 
@@ -105,6 +106,9 @@ struct inproc_sync *create_inproc_internal_sync( int manual, int signaled )
     if (!(event = alloc_object( &inproc_sync_ops ))) return NULL;
     event->type = INPROC_SYNC_INTERNAL;
     event->fd   = ioctl( get_inproc_device_fd(), NTSYNC_IOC_CREATE_EVENT, &args );
+    /* internal syncs can't be signaled by clients, and waits don't reset manual-reset ones,
+     * so we know their state and can skip redundant ioctls */
+    event->signaled = manual ? signaled : -1;
     list_init( &event->entry );
 
     if (event->fd == -1)
@@ -124,6 +128,7 @@ struct inproc_sync *create_inproc_event_sync( int manual, int signaled )
     if (!(event = alloc_object( &inproc_sync_ops ))) return NULL;
     event->type = INPROC_SYNC_EVENT;
     event->fd   = ioctl( get_inproc_device_fd(), NTSYNC_IOC_CREATE_EVENT, &args );
+    event->signaled = -1;
     list_init( &event->entry );
 
     if (event->fd == -1)
@@ -143,6 +148,7 @@ struct inproc_sync *create_inproc_mutex_sync( thread_id_t owner, unsigned int co
     if (!(mutex = alloc_object( &inproc_sync_ops ))) return NULL;
     mutex->type = INPROC_SYNC_MUTEX;
     mutex->fd   = ioctl( get_inproc_device_fd(), NTSYNC_IOC_CREATE_MUTEX, &args );
+    mutex->signaled = -1;
     list_add_tail( &inproc_mutexes, &mutex->entry );
 
     if (mutex->fd == -1)
@@ -162,6 +168,7 @@ struct inproc_sync *create_inproc_semaphore_sync( unsigned int initial, unsigned
     if (!(sem = alloc_object( &inproc_sync_ops ))) return NULL;
     sem->type = INPROC_SYNC_SEMAPHORE;
     sem->fd   = ioctl( get_inproc_device_fd(), NTSYNC_IOC_CREATE_SEM, &args );
+    sem->signaled = -1;
     list_init( &sem->entry );
 
     if (sem->fd == -1)
@@ -177,21 +184,25 @@ static void inproc_sync_dump( struct object *obj, int verbose )
 {
     struct inproc_sync *sync = (struct inproc_sync *)obj;
     assert( obj->ops == &inproc_sync_ops );
-    fprintf( stderr, "Inproc sync type=%d, fd=%d\n", sync->type, sync->fd );
+    fprintf( stderr, "Inproc sync type=%d, fd=%d, signaled=%d\n", sync->type, sync->fd, sync->signaled );
 }
 
 void signal_inproc_sync( struct inproc_sync *sync )
 {
     __u32 count;
+    if (sync->signaled == 1) return;  /* already signaled */
     if (debug_level) fprintf( stderr, "set_inproc_event %d\n", sync->fd );
     ioctl( sync->fd, NTSYNC_IOC_EVENT_SET, &count );
+    if (sync->signaled != -1) sync->signaled = 1;
 }
 
 void reset_inproc_sync( struct inproc_sync *sync )
 {
     __u32 count;
+    if (sync->signaled == 0) return;  /* already reset */
     if (debug_level) fprintf( stderr, "reset_inproc_event %d\n", sync->fd );
     ioctl( sync->fd, NTSYNC_IOC_EVENT_RESET, &count );
+    if (sync->signaled != -1) sync->signaled = 0;
 }
 
 static int inproc_sync_signal( struct object *obj, unsigned int access, int signal )
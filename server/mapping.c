@@ -1269,6 +1269,60 @@ static enum server_fd_type mapping_get_fd_type( struct fd *fd )
     return FD_TYPE_FILE;
 }
 
+/* make room for one more entry in the free ranges array */
+static int grow_addr_range( struct addr_range *range )
+{
+    unsigned int new_size;
+    void *new_free;
+
+    if (range->count < range->size) return 1;
+    new_size = max( 256, range->size * 2 );
+    if (!(new_free = realloc( range->free, new_size * sizeof(*range->free) ))) return 0;
+    range->size = new_size;
+    range->free = new_free;
+    return 1;
+}
+
+/* remove a specific address range from the free ranges, if it's entirely free */
+static int reserve_map_addr( client_ptr_t base, mem_size_t size )
+{
+    unsigned int i;
+    client_ptr_t end = base + size;
+    struct addr_range *range = (base >> 32) ? &ranges64 : &ranges32;
+
+    for (i = 0; i < range->count; i++)
+    {
+        client_ptr_t free_end = range->free[i].base + range->free[i].size;
+
+        if (range->free[i].base > base) continue;
+        if (free_end < end) return 0;
+
+        if (range->free[i].base == base && free_end == end)
+        {
+            range->count--;
+            memmove( &range->free[i], &range->free[i + 1], (range->count - i) * sizeof(*range->free) );
+        }
+        else if (range->free[i].base == base)
+        {
+            range->free[i].base = end;
+            range->free[i].size = free_end - end;
+        }
+        else if (free_end == end) range->free[i].size = base - range->free[i].base;
+        else
+        {
+            /* split the range, entries are sorted by decreasing address */
+            if (!grow_addr_range( range )) return 0;
+            memmove( &range->free[i + 1], &range->free[i], (range->count - i) * sizeof(*range->free) );
+            range->count++;
+            range->free[i].base = end;
+            range->free[i].size = free_end - end;
+            range->free[i + 1].size = base - range->free[i + 1].base;
+        }
+        return 1;
+    }
+    return 0;
+}
+
 /* assign a mapping address to a PE image mapping */
 static client_ptr_t assign_map_address( struct mapping *mapping )
 {
@@ -1283,6 +1337,14 @@ static client_ptr_t assign_map_address( struct mapping *mapping )
 
     size += granularity_mask + 1;  /* leave some free space between mappings */
 
+    /* use the preferred base if it's available; the image then doesn't need any relocations,
+     * so all processes can share its pages straight from the page cache */
+    if (!(mapping->image.base & granularity_mask) && reserve_map_addr( mapping->image.base, size ))
+    {
+        set_fd_map_address( mapping->fd, mapping->image.base, size );
+        return mapping->image.base;
+    }
+
     for (i = 0; i < range->count; i++)
     {
         if (range->free[i].size < size) continue;
@@ -1319,14 +1381,7 @@ void free_map_addr( client_ptr_t base, mem_size_t size )
         return;
     }
 
-    if (range->count == range->size)
-    {
-        unsigned int new_size = max( 256, range->size * 2 );
-        void *new_free = realloc( range->free, new_size * sizeof(*range->free) );
-        if (!new_free) return;
-        range->size = new_size;
-        range->free = new_free;
-    }
+    if (!grow_addr_range( range )) return;
     memmove( &range->free[i + 1], &range->free[i], (range->count - i) * sizeof(*range->free) );
     range->free[i].base = base;
     range->free[i].size = size;
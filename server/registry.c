@@ -115,6 +115,8 @@ struct key_value
 #define MIN_SUBKEYS  8   /* min. number of allocated subkeys per key */
 #define MIN_VALUES   8   /* min. number of allocated values per key */
 
+#define SAVE_BUFFER_SIZE 65536  /* size of the stdio buffer used when saving a branch */
+
 #define MAX_NAME_LEN  256    /* max. length of a key name */
 #define MAX_VALUE_LEN 16383  /* max. length of a value name */
 
@@ -232,10 +234,43 @@ static void dump_path( const struct key *key, const struct key *base, FILE *f )
     dump_strW( key->obj.name->name, key->obj.name->len, f, "[]" );
 }
 
+/* dump binary data in hex format; count is the current output column */
+static void dump_hex_data( const unsigned char *data, data_size_t len, int count, FILE *f )
+{
+    static const char hex[16] = "0123456789abcdef";
+    char buffer[256];
+    char *pos = buffer;
+    data_size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (pos > buffer + sizeof(buffer) - 8)
+        {
+            fwrite( buffer, pos - buffer, 1, f );
+            pos = buffer;
+        }
+        *pos++ = hex[data[i] >> 4];
+        *pos++ = hex[data[i] & 0x0f];
+        count += 2;
+        if (i < len - 1)
+        {
+            *pos++ = ',';
+            if (++count > 76)
+            {
+                memcpy( pos, "\\\n  ", 4 );
+                pos += 4;
+                count = 2;
+            }
+        }
+    }
+    *pos++ = '\n';
+    fwrite( buffer, pos - buffer, 1, f );
+}
+
 /* dump a value to a text file */
 static void dump_value( const struct key_value *value, FILE *f )
 {
-    unsigned int i, dw;
+    unsigned int dw;
     int count;
 
     if (value->namelen)
@@ -270,20 +305,7 @@ static void dump_value( const struct key_value *value, FILE *f )
 
     if (value->type == REG_BINARY) count += fprintf( f, "hex:" );
     else count += fprintf( f, "hex(%x):", value->type );
-    for (i = 0; i < value->len; i++)
-    {
-        count += fprintf( f, "%02x", *((unsigned char *)value->data + i) );
-        if (i < value->len-1)
-        {
-            fputc( ',', f );
-            if (++count > 76)
-            {
-                fprintf( f, "\\\n  " );
-                count = 2;
-            }
-        }
-    }
-    fputc( '\n', f );
+    dump_hex_data( value->data, value->len, count, f );
 }
 
 /* find the named child of a given key and return its index */
@@ -583,7 +605,7 @@ static int key_link_name( struct object *obj, struct object_name *name, struct o
     struct key *key = (struct key *)obj;
     struct key *parent_key = (struct key *)parent;
     struct unicode_str tmp;
-    int i, index;
+    int index;
 
     if (parent->ops != &key_ops)
     {
@@ -602,8 +624,8 @@ static int key_link_name( struct object *obj, struct object_name *name, struct o
     tmp.len = name->len;
     find_subkey( parent_key, &tmp, &index );
 
-    for (i = ++parent_key->last_subkey; i > index; i--)
-        parent_key->subkeys[i] = parent_key->subkeys[i - 1];
+    memmove( parent_key->subkeys + index + 1, parent_key->subkeys + index,
+             (++parent_key->last_subkey - index) * sizeof(*parent_key->subkeys) );
     parent_key->subkeys[index] = (struct key *)grab_object( key );
     if (is_wow6432node( name->name, name->len ) &&
         !is_wow6432node( parent_key->obj.name->name, parent_key->obj.name->len ))
@@ -616,7 +638,9 @@ static void key_unlink_name( struct object *obj, struct object_name *name )
 {
     struct key *key = (struct key *)obj;
     struct key *parent = (struct key *)name->parent;
-    int i, nb_subkeys;
+    struct key *found;
+    struct unicode_str tmp;
+    int index, nb_subkeys;
 
     if (!parent) return;
 
@@ -626,9 +650,12 @@ static void key_unlink_name( struct object *obj, struct object_name *name )
         return;
     }
 
-    for (i = 0; i <= parent->last_subkey; i++) if (parent->subkeys[i] == key) break;
-    assert( i <= parent->last_subkey );
-    for ( ; i < parent->last_subkey; i++) parent->subkeys[i] = parent->subkeys[i + 1];
+    tmp.str = name->name;
+    tmp.len = name->len;
+    found = find_subkey( parent, &tmp, &index );
+    assert( found == key );
+    memmove( parent->subkeys + index, parent->subkeys + index + 1,
+             (parent->last_subkey - index) * sizeof(*parent->subkeys) );
     parent->last_subkey--;
     name->parent = NULL;
     if (parent->wow6432node == key) parent->wow6432node = NULL;
@@ -1003,8 +1030,9 @@ static void rename_key( struct key *key, const struct unicode_str *new_name )
 {
     struct object_name *new_name_ptr;
     struct key *parent = get_parent( key );
+    struct unicode_str old_name;
     data_size_t len;
-    int i, index, cur_index;
+    int index, cur_index;
 
     /* changing to a path is not allowed */
     len = get_path_element( new_name->str, new_name->len );
@@ -1035,17 +1063,21 @@ static void rename_key( struct key *key, const struct unicode_str *new_name )
     new_name_ptr->parent = &parent->obj;
     memcpy( new_name_ptr->name, new_name->str, new_name->len );
 
-    for (cur_index = 0; cur_index <= parent->last_subkey; cur_index++)
-        if (parent->subkeys[cur_index] == key) break;
+    old_name.str = key->obj.name->name;
+    old_name.len = key->obj.name->len;
+    find_subkey( parent, &old_name, &cur_index );
+    assert( parent->subkeys[cur_index] == key );
 
     if (cur_index < index)
     {
         --index;
-        for (i = cur_index; i < index; ++i) parent->subkeys[i] = parent->subkeys[i+1];
+        memmove( parent->subkeys + cur_index, parent->subkeys + cur_index + 1,
+                 (index - cur_index) * sizeof(*parent->subkeys) );
     }
     else if (cur_index > index)
     {
-        for (i = cur_index; i > index; --i) parent->subkeys[i] = parent->subkeys[i-1];
+        memmove( parent->subkeys + index + 1, parent->subkeys + index,
+                 (cur_index - index) * sizeof(*parent->subkeys) );
     }
     parent->subkeys[index] = key;
 
@@ -1148,7 +1180,6 @@ static struct key_value *insert_value( struct key *key, const struct unicode_str
 {
     struct key_value *value;
     WCHAR *new_name = NULL;
-    int i;
 
     if (name->len > MAX_VALUE_LEN * sizeof(WCHAR))
     {
@@ -1160,7 +1191,8 @@ static struct key_value *insert_value( struct key *key, const struct unicode_str
         if (!grow_values( key )) return NULL;
     }
     if (name->len && !(new_name = memdup( name->str, name->len ))) return NULL;
-    for (i = ++key->last_value; i > index; i--) key->values[i] = key->values[i - 1];
+    memmove( key->values + index + 1, key->values + index,
+             (++key->last_value - index) * sizeof(*key->values) );
     value = &key->values[index];
     value->name    = new_name;
     value->namelen = name->len;
@@ -1310,7 +1342,7 @@ static void enum_value( struct key *key, int i, int info_class, struct enum_key_
 static void delete_value( struct key *key, const struct unicode_str *name )
 {
     struct key_value *value;
-    int i, index, nb_values;
+    int index, nb_values;
 
     if (key->flags & KEY_PREDEF)
     {
@@ -1326,7 +1358,8 @@ static void delete_value( struct key *key, const struct unicode_str *name )
     if (debug_level > 1) dump_operation( key, value, "Delete" );
     free( value->name );
     free( value->data );
-    for (i = index; i < key->last_value; i++) key->values[i] = key->values[i + 1];
+    memmove( key->values + index, key->values + index + 1,
+             (key->last_value - index) * sizeof(*key->values) );
     key->last_value--;
     touch_key( key, REG_NOTIFY_CHANGE_LAST_SET );
 
@@ -2107,6 +2140,9 @@ static int save_branch( struct key *key, const char *filename )
         dump_operation( key, NULL, "saving" );
     }
 
+    /* hives can be large, use a bigger buffer than the stdio default */
+    setvbuf( f, NULL, _IOFBF, SAVE_BUFFER_SIZE );
+
     save_all_subkeys( key, f );
     ret = !fclose(f);
 
@@ -324,6 +324,13 @@ static void call_req_handler( struct thread *thread )
     current = NULL;
 }
 
+/* free the variable-size data of the current request */
+static void free_req_data( struct thread *thread )
+{
+    if (thread->req_data != thread->req_buffer) free( thread->req_data );
+    thread->req_data = NULL;
+}
+
 /* read a request from a thread */
 void read_request( struct thread *thread )
 {
@@ -331,20 +338,52 @@ void read_request( struct thread *thread )
 
     if (!thread->req_toread)  /* no pending request */
     {
-        if ((ret = read( get_unix_fd( thread->request_fd ), &thread->req,
-                         sizeof(thread->req) )) != sizeof(thread->req)) goto error;
+        struct iovec vec[2];
+        int count = 1;
+
+        /* read the header and as much of the data as fits in the
+         * preallocated buffer at once, to save a syscall in the common case */
+        if (!thread->req_buffer) thread->req_buffer = malloc( REQ_BUFFER_SIZE );
+        vec[0].iov_base = &thread->req;
+        vec[0].iov_len  = sizeof(thread->req);
+        if (thread->req_buffer)
+        {
+            vec[1].iov_base = thread->req_buffer;
+            vec[1].iov_len  = REQ_BUFFER_SIZE;
+            count = 2;
+        }
+
+        if ((ret = readv( get_unix_fd( thread->request_fd ), vec, count )) < (int)sizeof(thread->req))
+            goto error;
+        ret -= sizeof(thread->req);
+        if (ret > thread->req.request_header.request_size)
+        {
+            fatal_protocol_error( thread, "request data overflow %d/%u\n",
+                                  ret, thread->req.request_header.request_size );
+            return;
+        }
         if (!(thread->req_toread = thread->req.request_header.request_size))
         {
             /* no data, handle request at once */
             call_req_handler( thread );
             return;
         }
-        if (!(thread->req_data = malloc( thread->req_toread )))
+        if (thread->req_buffer && thread->req_toread <= REQ_BUFFER_SIZE)
+            thread->req_data = thread->req_buffer;
+        else if (!(thread->req_data = malloc( thread->req_toread )))
         {
             fatal_protocol_error( thread, "no memory for %u bytes request %d\n",
                                   thread->req_toread, thread->req.request_header.req );
             return;
         }
+        else if (ret) memcpy( thread->req_data, thread->req_buffer, ret );
+
+        if (!(thread->req_toread -= ret))
+        {
+            call_req_handler( thread );
+            free_req_data( thread );
+            return;
+        }
     }
 
     /* read the variable sized data */
@@ -358,8 +397,7 @@ void read_request( struct thread *thread )
         if (!(thread->req_toread -= ret))
         {
             call_req_handler( thread );
-            free( thread->req_data );
-            thread->req_data = NULL;
+            free_req_data( thread );
             return;
         }
     }
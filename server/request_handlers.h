@@ -966,9 +966,13 @@ C_ASSERT( offsetof(struct create_file_request, sharing) == 16 );
 C_ASSERT( offsetof(struct create_file_request, create) == 20 );
 C_ASSERT( offsetof(struct create_file_request, options) == 24 );
 C_ASSERT( offsetof(struct create_file_request, attrs) == 28 );
-C_ASSERT( sizeof(struct create_file_request) == 32 );
+C_ASSERT( offsetof(struct create_file_request, want_fd) == 32 );
+C_ASSERT( sizeof(struct create_file_request) == 40 );
 C_ASSERT( offsetof(struct create_file_reply, handle) == 8 );
-C_ASSERT( sizeof(struct create_file_reply) == 16 );
+C_ASSERT( offsetof(struct create_file_reply, fd_type) == 12 );
+C_ASSERT( offsetof(struct create_file_reply, fd_access) == 16 );
+C_ASSERT( offsetof(struct create_file_reply, fd_options) == 20 );
+C_ASSERT( sizeof(struct create_file_reply) == 24 );
 C_ASSERT( offsetof(struct open_file_object_request, access) == 12 );
 C_ASSERT( offsetof(struct open_file_object_request, attributes) == 16 );
 C_ASSERT( offsetof(struct open_file_object_request, rootdir) == 20 );
@@ -1032,6 +1036,7 @@ C_ASSERT( sizeof(struct recv_socket_request) == 64 );
 C_ASSERT( offsetof(struct recv_socket_reply, wait) == 8 );
 C_ASSERT( offsetof(struct recv_socket_reply, options) == 12 );
 C_ASSERT( offsetof(struct recv_socket_reply, nonblocking) == 16 );
+C_ASSERT( offsetof(struct recv_socket_reply, icmp_over_dgram) == 20 );
 C_ASSERT( sizeof(struct recv_socket_reply) == 24 );
 C_ASSERT( offsetof(struct send_socket_request, flags) == 12 );
 C_ASSERT( offsetof(struct send_socket_request, async) == 16 );
@@ -1039,7 +1044,9 @@ C_ASSERT( sizeof(struct send_socket_request) == 56 );
 C_ASSERT( offsetof(struct send_socket_reply, wait) == 8 );
 C_ASSERT( offsetof(struct send_socket_reply, options) == 12 );
 C_ASSERT( offsetof(struct send_socket_reply, nonblocking) == 16 );
-C_ASSERT( sizeof(struct send_socket_reply) == 24 );
+C_ASSERT( offsetof(struct send_socket_reply, unix_type) == 20 );
+C_ASSERT( offsetof(struct send_socket_reply, icmp_over_dgram) == 24 );
+C_ASSERT( sizeof(struct send_socket_reply) == 32 );
 C_ASSERT( offsetof(struct socket_get_events_request, handle) == 12 );
 C_ASSERT( offsetof(struct socket_get_events_request, event) == 16 );
 C_ASSERT( sizeof(struct socket_get_events_request) == 24 );
@@ -21,6 +21,7 @@ static void dump_varargs_acl( const char *prefix, data_size_t size );
 static void dump_varargs_apc_call( const char *prefix, data_size_t size );
 static void dump_varargs_apc_result( const char *prefix, data_size_t size );
 static void dump_varargs_bytes( const char *prefix, data_size_t size );
+static void dump_varargs_completion_packets( const char *prefix, data_size_t size );
 static void dump_varargs_contexts( const char *prefix, data_size_t size );
 static void dump_varargs_cursor_positions( const char *prefix, data_size_t size );
 static void dump_varargs_debug_event( const char *prefix, data_size_t size );
@@ -625,6 +626,7 @@ static void dump_create_file_request( const struct create_file_request *req )
     fprintf( stderr, ", create=%d", req->create );
     fprintf( stderr, ", options=%08x", req->options );
     fprintf( stderr, ", attrs=%08x", req->attrs );
+    fprintf( stderr, ", want_fd=%d", req->want_fd );
     dump_varargs_object_attributes( ", objattr=", cur_size );
     dump_varargs_string( ", filename=", cur_size );
 }
@@ -632,6 +634,9 @@ static void dump_create_file_request( const struct create_file_request *req )
 static void dump_create_file_reply( const struct create_file_reply *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", fd_type=%d", req->fd_type );
+    fprintf( stderr, ", fd_access=%08x", req->fd_access );
+    fprintf( stderr, ", fd_options=%08x", req->fd_options );
 }
 
 static void dump_open_file_object_request( const struct open_file_object_request *req )
@@ -764,6 +769,7 @@ static void dump_recv_socket_reply( const struct recv_socket_reply *req )
     fprintf( stderr, " wait=%04x", req->wait );
     fprintf( stderr, ", options=%08x", req->options );
     fprintf( stderr, ", nonblocking=%d", req->nonblocking );
+    fprintf( stderr, ", icmp_over_dgram=%d", req->icmp_over_dgram );
 }
 
 static void dump_send_socket_request( const struct send_socket_request *req )
@@ -777,6 +783,8 @@ static void dump_send_socket_reply( const struct send_socket_reply *req )
     fprintf( stderr, " wait=%04x", req->wait );
     fprintf( stderr, ", options=%08x", req->options );
     fprintf( stderr, ", nonblocking=%d", req->nonblocking );
+    fprintf( stderr, ", unix_type=%d", req->unix_type );
+    fprintf( stderr, ", icmp_over_dgram=%d", req->icmp_over_dgram );
 }
 
 static void dump_socket_get_events_request( const struct socket_get_events_request *req )
@@ -3115,6 +3123,7 @@ static void dump_remove_completion_reply( const struct remove_completion_reply *
     dump_uint64( ", information=", &req->information );
     fprintf( stderr, ", status=%08x", req->status );
     fprintf( stderr, ", wait_handle=%04x", req->wait_handle );
+    dump_varargs_completion_packets( ", packets=", cur_size );
 }
 
 static void dump_get_thread_completion_request( const struct get_thread_completion_request *req )
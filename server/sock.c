@@ -167,6 +167,17 @@ union unix_sockaddr
 
 static struct list poll_list = LIST_INIT( poll_list );
 
+struct poll_req_socket
+{
+    struct list entry;          /* entry in the socket's list of poll requests */
+    struct poll_req *req;
+    struct sock *sock;
+    int mask;
+    obj_handle_t handle;
+    int flags;
+    unsigned int status;
+};
+
 struct poll_req
 {
     struct list entry;
@@ -177,14 +188,7 @@ struct poll_req
     int exclusive;
     int pending;
     unsigned int count;
-    struct
-    {
-        struct sock *sock;
-        int mask;
-        obj_handle_t handle;
-        int flags;
-        unsigned int status;
-    } sockets[1];
+    struct poll_req_socket sockets[1];
 };
 
 struct accept_req
@@ -270,6 +274,7 @@ struct sock
     struct object      *ifchange_obj; /* the interface change notification object */
     struct list         ifchange_entry; /* entry in ifchange notification list */
     struct list         accept_list; /* list of pending accept requests */
+    struct list         poll_list;   /* list of poll request entries for this socket */
     struct accept_req  *accept_recv_req; /* pending accept-into request which will recv on this socket */
     struct connect_req *connect_req; /* pending connection request */
     struct poll_req    *main_poll;   /* main poll */
@@ -299,6 +304,7 @@ struct sock
     unsigned int        reset : 1;   /* did we get a TCP reset? */
     unsigned int        reuseaddr : 1; /* winsock SO_REUSEADDR option value */
     unsigned int        exclusiveaddruse : 1; /* winsock SO_EXCLUSIVEADDRUSE option value */
+    unsigned int        icmp_over_dgram : 1; /* is this a raw ICMP socket emulated over SOCK_DGRAM? */
 };
 
 static int is_tcp_socket( struct sock *sock )
@@ -1109,7 +1115,10 @@ static void free_poll_req( void *private )
     if (req->timeout) remove_timeout_user( req->timeout );
 
     for (i = 0; i < req->count; ++i)
+    {
+        list_remove( &req->sockets[i].entry );
         release_object( req->sockets[i].sock );
+    }
     release_object( req->async );
     release_object( req->iosb );
     list_remove( &req->entry );
@@ -1228,34 +1237,41 @@ static void complete_async_poll( struct poll_req *req, unsigned int status )
     }
 }
 
+/* Return the first entry after the given one which belongs to a different request.
+ * The entries of a request are added together, so they are adjacent in the list. */
+static struct poll_req_socket *skip_poll_req_entries( struct sock *sock, struct poll_req_socket *entry )
+{
+    struct poll_req *req = entry->req;
+
+    do entry = LIST_ENTRY( entry->entry.next, struct poll_req_socket, entry );
+    while (&entry->entry != &sock->poll_list && entry->req == req);
+    return entry;
+}
+
 static void complete_async_polls( struct sock *sock, int event, int error )
 {
     int flags = get_poll_flags( sock, event );
-    struct poll_req *req, *next;
+    struct poll_req_socket *entry, *next;
 
-    LIST_FOR_EACH_ENTRY_SAFE( req, next, &poll_list, struct poll_req, entry )
+    LIST_FOR_EACH_ENTRY_SAFE( entry, next, &sock->poll_list, struct poll_req_socket, entry )
     {
-        unsigned int i;
+        struct poll_req *req = entry->req;
 
         if (req->iosb->status != STATUS_PENDING) continue;
+        if (!(entry->mask & flags)) continue;
 
-        for (i = 0; i < req->count; ++i)
-        {
-            if (req->sockets[i].sock != sock) continue;
-            if (!(req->sockets[i].mask & flags)) continue;
-
-            if (debug_level)
-                fprintf( stderr, "completing poll for socket %p, wanted %#x got %#x\n",
-                         sock, req->sockets[i].mask, flags );
+        if (debug_level)
+            fprintf( stderr, "completing poll for socket %p, wanted %#x got %#x\n",
+                     sock, entry->mask, flags );
 
-            req->sockets[i].flags = req->sockets[i].mask & flags;
-            req->sockets[i].status = sock_get_ntstatus( error );
+        entry->flags = entry->mask & flags;
+        entry->status = sock_get_ntstatus( error );
 
-            if (req->pending)
-            {
-                complete_async_poll( req, STATUS_SUCCESS );
-                break;
-            }
+        if (req->pending)
+        {
+            /* completing the request may free it, including its other entries */
+            next = skip_poll_req_entries( sock, entry );
+            complete_async_poll( req, STATUS_SUCCESS );
         }
     }
 }
@@ -1541,7 +1557,7 @@ static int sock_get_poll_events( struct fd *fd )
 {
     struct sock *sock = get_fd_user( fd );
     unsigned int mask = sock->mask & ~sock->reported_events;
-    struct poll_req *req;
+    struct poll_req_socket *entry;
     int ev = 0;
 
     assert( sock->obj.ops == &sock_ops );
@@ -1549,18 +1565,11 @@ static int sock_get_poll_events( struct fd *fd )
     if (!sock->type) /* not initialized yet */
         return -1;
 
-    LIST_FOR_EACH_ENTRY( req, &poll_list, struct poll_req, entry )
+    LIST_FOR_EACH_ENTRY( entry, &sock->poll_list, struct poll_req_socket, entry )
     {
-        unsigned int i;
+        if (entry->req->iosb->status != STATUS_PENDING) continue;
 
-        if (req->iosb->status != STATUS_PENDING) continue;
-
-        for (i = 0; i < req->count; ++i)
-        {
-            if (req->sockets[i].sock != sock) continue;
-
-            ev |= poll_flags_from_afd( sock, req->sockets[i].mask );
-        }
+        ev |= poll_flags_from_afd( sock, entry->mask );
     }
 
     switch (sock->state)
@@ -1710,7 +1719,7 @@ static int sock_close_handle( struct object *obj, struct process *process, obj_h
     if (sock->obj.handle_count == 1) /* last handle */
     {
         struct accept_req *accept_req, *accept_next;
-        struct poll_req *poll_req, *poll_next;
+        struct poll_req_socket *entry, *next;
 
         if (sock->accept_recv_req)
             async_terminate( sock->accept_recv_req->async, STATUS_CANCELLED );
@@ -1721,25 +1730,18 @@ static int sock_close_handle( struct object *obj, struct process *process, obj_h
         if (sock->connect_req)
             async_terminate( sock->connect_req->async, STATUS_CANCELLED );
 
-        LIST_FOR_EACH_ENTRY_SAFE( poll_req, poll_next, &poll_list, struct poll_req, entry )
+        LIST_FOR_EACH_ENTRY_SAFE( entry, next, &sock->poll_list, struct poll_req_socket, entry )
         {
-            struct iosb *iosb = poll_req->iosb;
-            BOOL signaled = FALSE;
-            unsigned int i;
+            struct poll_req *poll_req = entry->req;
 
-            if (iosb->status != STATUS_PENDING) continue;
+            if (poll_req->iosb->status != STATUS_PENDING) continue;
 
-            for (i = 0; i < poll_req->count; ++i)
-            {
-                if (poll_req->sockets[i].sock == sock)
-                {
-                    signaled = TRUE;
-                    poll_req->sockets[i].flags = AFD_POLL_CLOSE;
-                    poll_req->sockets[i].status = 0;
-                }
-            }
+            entry->flags = AFD_POLL_CLOSE;
+            entry->status = 0;
 
-            if (signaled) complete_async_poll( poll_req, STATUS_SUCCESS );
+            /* complete the request once all of its entries for this socket are signaled */
+            if (&next->entry == &sock->poll_list || next->req != poll_req)
+                complete_async_poll( poll_req, STATUS_SUCCESS );
         }
     }
     return async_close_obj_handle( obj, process, handle );
@@ -1820,6 +1822,7 @@ static struct sock *create_socket(void)
     sock->rcvtimeo = 0;
     sock->sndtimeo = 0;
     sock->icmp_fixup_data_len = 0;
+    sock->icmp_over_dgram = 0;
     sock->bound_addr[0] = sock->bound_addr[1] = NULL;
     init_async_queue( &sock->read_q );
     init_async_queue( &sock->write_q );
@@ -1829,6 +1832,7 @@ static struct sock *create_socket(void)
     init_async_queue( &sock->poll_q );
     memset( sock->errors, 0, sizeof(sock->errors) );
     list_init( &sock->accept_list );
+    list_init( &sock->poll_list );
     return sock;
 }
 
@@ -1863,6 +1867,12 @@ static int get_unix_type( int type )
     }
 }
 
+static int get_sock_unix_type( struct sock *sock )
+{
+    if (sock->icmp_over_dgram) return SOCK_DGRAM;
+    return sock->type ? get_unix_type( sock->type ) : 0;
+}
+
 static int get_unix_protocol( int family, int protocol )
 {
     if (protocol >= WS_NSPROTO_IPX && protocol <= WS_NSPROTO_IPX + 255)
@@ -1958,6 +1968,8 @@ static int init_socket( struct sock *sock, int family, int type, int protocol )
         {
             const int val = 1;
 
+            sock->icmp_over_dgram = 1;
+
             if (unix_family == AF_INET6)
             {
 #ifdef IPV6_RECVPKTINFO
@@ -3628,6 +3640,7 @@ static void poll_socket( struct sock *poll_sock, struct async *async, int exclus
             free( req );
             return;
         }
+        req->sockets[i].req = req;
         req->sockets[i].handle = sockets[i].socket;
         req->sockets[i].mask = sockets[i].flags;
         req->sockets[i].flags = 0;
@@ -3641,6 +3654,8 @@ static void poll_socket( struct sock *poll_sock, struct async *async, int exclus
     handle_exclusive_poll(req);
 
     list_add_tail( &poll_list, &req->entry );
+    for (i = 0; i < count; ++i)
+        list_add_tail( &req->sockets[i].sock->poll_list, &req->sockets[i].entry );
     async_set_completion_callback( async, free_poll_req, req );
     queue_async( &poll_sock->poll_q, async );
 
@@ -4040,6 +4055,7 @@ DECL_HANDLER(recv_socket)
         reply->wait = async_handoff( async, NULL, 0 );
         reply->options = get_fd_options( fd );
         reply->nonblocking = sock->nonblocking;
+        reply->icmp_over_dgram = sock->icmp_over_dgram;
         release_object( async );
     }
     release_object( sock );
@@ -4165,6 +4181,8 @@ DECL_HANDLER(send_socket)
         reply->wait = async_handoff( async, NULL, 0 );
         reply->options = get_fd_options( fd );
         reply->nonblocking = sock->nonblocking;
+        reply->unix_type = get_sock_unix_type( sock );
+        reply->icmp_over_dgram = sock->icmp_over_dgram;
         release_object( async );
     }
     release_object( sock );
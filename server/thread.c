@@ -410,6 +410,7 @@ static inline void init_thread_structure( struct thread *thread )
     thread->wait            = NULL;
     thread->error           = 0;
     thread->req_data        = NULL;
+    thread->req_buffer      = NULL;
     thread->req_toread      = 0;
     thread->reply_data      = NULL;
     thread->reply_towrite   = 0;
@@ -620,7 +621,8 @@ static void cleanup_thread( struct thread *thread )
     }
     clear_apc_queue( &thread->system_apc );
     clear_apc_queue( &thread->user_apc );
-    free( thread->req_data );
+    if (thread->req_data != thread->req_buffer) free( thread->req_data );
+    free( thread->req_buffer );
     free( thread->reply_data );
     if (thread->request_fd) release_object( thread->request_fd );
     if (thread->reply_fd) release_object( thread->reply_fd );
@@ -639,6 +641,7 @@ static void cleanup_thread( struct thread *thread )
     }
     free( thread->desc );
     thread->req_data = NULL;
+    thread->req_buffer = NULL;
     thread->reply_data = NULL;
     thread->request_fd = NULL;
     thread->reply_fd = NULL;
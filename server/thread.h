@@ -46,6 +46,7 @@ struct inflight_fd
     int server;  /* fd on the server side */
 };
 #define MAX_INFLIGHT_FDS 16  /* max number of fds in flight per thread */
+#define REQ_BUFFER_SIZE  1024  /* size of the preallocated buffer for small request data */
 
 struct thread
 {
@@ -68,6 +69,7 @@ struct thread
     unsigned int           error;         /* current error code */
     union generic_request  req;           /* current request */
     void                  *req_data;      /* variable-size data for request */
+    void                  *req_buffer;    /* preallocated buffer for small request data */
     unsigned int           req_toread;    /* amount of data still to read in request */
     void                  *reply_data;    /* variable-size data for reply */
     unsigned int           reply_size;    /* size of reply data */
@@ -1404,6 +1404,25 @@ static void dump_varargs_rawinput_devices(const char *prefix, data_size_t size )
     fputc( '}', stderr );
 }
 
+static void dump_varargs_completion_packets( const char *prefix, data_size_t size )
+{
+    const struct completion_packet *packet;
+
+    fprintf( stderr, "%s{", prefix );
+    while (size >= sizeof(*packet))
+    {
+        packet = cur_data;
+        dump_uint64( "{ckey=", &packet->ckey );
+        dump_uint64( ",cvalue=", &packet->cvalue );
+        dump_uint64( ",information=", &packet->information );
+        fprintf( stderr, ",status=%08x}", packet->status );
+        size -= sizeof(*packet);
+        remove_data( sizeof(*packet) );
+        if (size) fputc( ',', stderr );
+    }
+    fputc( '}', stderr );
+}
+
 static void dump_varargs_handle_infos( const char *prefix, data_size_t size )
 {
     const struct handle_info *handle;
@@ -491,6 +491,26 @@ static int try_link( struct strarray link_tool, const char *cflags )
     return ret;
 }
 
+/* compute a stable default base address for a builtin dll, so that builtins don't all
+ * collide at the linker default; the range matches the server's dll mapping area, where
+ * the preferred base is used when it's free.
+ * This is only done for 64-bit targets: the name hash picks one of 256k slots of 64Mb,
+ * so colliding pairs are rare even across all builtins, and only images larger than
+ * 64Mb can overlap the next slot. A 32-bit address space has no room for that many
+ * slots, so 32-bit builtins keep the linker default there.
+ * On a collision, the loader simply relocates the image to a free address. */
+static const char *get_builtin_image_base( const char *output_name )
+{
+    unsigned int hash = 0;
+    const char *p;
+
+    if (get_target_ptr_size( target ) != 8) return NULL;
+
+    for (p = output_name; *p; p++) hash = hash * 31 + tolower( (unsigned char)*p );
+
+    return strmake( "0x%llx", 0x600000000000ull + ((unsigned long long)(hash % 0x40000) << 26) );
+}
+
 static struct strarray get_link_args( const char *output_name )
 {
     struct strarray link_args = get_translator();
@@ -1367,6 +1387,9 @@ static void build(struct strarray input_files, const char *output)
     if (is_pe && !entry_point && (is_shared || is_win16_app))
         entry_point = target.cpu == CPU_i386 ? "DllMainCRTStartup@12" : "DllMainCRTStartup";
 
+    if (is_pe && is_shared && wine_builtin && !image_base)
+        image_base = get_builtin_image_base( output_name );
+
     /* link everything together now */
     link_args = get_link_args( output_name );
 